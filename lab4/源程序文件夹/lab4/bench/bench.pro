@@ -0,0 +1,29 @@
+QT       = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = lrbench
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../codegen.cpp \
+    ../compiledtable.cpp \
+    ../grammar.cpp \
+    ../llparser.cpp \
+    ../lr.cpp \
+    ../lrparser.cpp \
+    main.cpp
+
+HEADERS += \
+    ../codegen.h \
+    ../compiledtable.h \
+    ../grammar.h \
+    ../llparser.h \
+    ../lr.h \
+    ../lrparser.h \
+    ../terminalset.h
+
+# 峰值内存读取 GetProcessMemoryInfo
+win32: LIBS += -lpsapi
@@ -0,0 +1,647 @@
+// LR 构造基准：对给定文法文件分别构造 SLR(1)、LALR(1)、LR(1)（单线程与多线程）、最小 LR(1) 分析表
+// 以及打包后的数组表（构造前先删去无用符号），报告状态数、项目数、表格格子数、冲突数、用时、峰值内存与内存分配次数。
+// 惰性 LR(1) 一项把构造与分析一批句子一起计时，只展开句子实际走到的状态。
+// 同时构造 LL(1) 预测分析表；文法是 LL(1) 时，再用同一批推导出的句子比较 LLParser 与 LRParser 的分析速度。
+// grammars/ 下为基准语料：expr、json、pascal（子集）、c89、java（子集），
+// 消除左递归后的 LL(1) 版本 expr_ll、json_ll，以及用 %left/%right 声明消除二义性的单层表达式文法 expr_prec。
+//
+// 用法：lrbench [--scale N] [--threads N] [--repeat N] [--json FILE] grammar.txt...
+//        lrbench --generate DIR grammar.txt...
+//   --scale N       将每个文法复制 1, 2, 4, ..., N 份（非终结符改名、各份以不同终结符引导），
+//                   用来观察状态数线性增长时构造时间的增长趋势。
+//   --threads N     多线程 LR(1) 构造使用的线程数，默认为 CPU 核数。
+//   --repeat N      每项测量重复 N 次取最短用时，默认 1。
+//   --json FILE     把全部结果以 JSON 写入 FILE（"-" 为标准输出，此时不再打印文本表格），
+//                   便于保存下来与后续版本比较。
+//   --generate DIR  对每个文法 <name>.txt 用最小 LR(1) 表生成 DIR/<name>_table.h（表驱动）、
+//                   DIR/<name>_ra.h（递归上升）以及句子语料 DIR/<name>_sentences.txt，
+//                   供 rabench 比较两种生成代码的分析速度。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif !defined(Q_OS_LINUX)
+#include <sys/resource.h>
+#endif
+
+#include "codegen.h"
+#include "compiledtable.h"
+#include "grammar.h"
+#include "llparser.h"
+#include "lr.h"
+#include "lrparser.h"
+
+// 内存分配计数。glibc 下直接替换 malloc/calloc/realloc，Qt 容器（QArrayData 走 malloc）
+// 与 operator new 的分配都能计入；其它平台只替换 operator new，不含 Qt 容器自身的缓冲区
+static std::atomic<qint64> allocationCount{0};
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+}
+#else
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+// 峰值常驻内存。Linux 下每次测量前通过 /proc/self/clear_refs 把峰值重置为当前值，
+// 读到的是这次测量期间的峰值（含进程已占用的部分）；其它平台无法重置，读到的是进程启动以来的峰值
+static void resetPeakRss()
+{
+#if defined(Q_OS_LINUX)
+    QFile f("/proc/self/clear_refs");
+    if (f.open(QIODevice::WriteOnly)) f.write("5");
+#endif
+}
+
+static qint64 peakRssKb()
+{
+#if defined(Q_OS_LINUX)
+    QFile f("/proc/self/status");
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+    for (const QByteArray &line : f.readAll().split('\n')) {
+        if (line.startsWith("VmHWM:")) return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+    return 0;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return qint64(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(Q_OS_MACOS)
+    return usage.ru_maxrss / 1024; // macOS 以字节为单位
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static bool readText(const QString &fileName, QString &text)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    QTextStream in(&f);
+    text = in.readAll();
+    return true;
+}
+
+static bool writeText(const QString &fileName, const QString &text)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&f);
+    out << text;
+    return true;
+}
+
+// 随机推导一个句子；深度超过 depthLimit 后总选最短的候选式以保证终止
+static bool deriveSentence(const Grammar &g, int sym, int depth, std::mt19937 &rng, QVector<int> &out)
+{
+    const int depthLimit = 8;
+    if (g.isTerminal(sym)) {
+        out.append(sym);
+        return out.size() < 2000;
+    }
+    const QVector<int> &alts = g.prodsByLeft[sym];
+    int prodId = alts[rng() % alts.size()];
+    if (depth > depthLimit) {
+        for (int p : alts) {
+            if (g.productions[p].right.size() < g.productions[prodId].right.size()) prodId = p;
+        }
+    }
+    if (depth > 10 * depthLimit) return false;
+    for (int X : g.productions[prodId].right) {
+        if (!deriveSentence(g, X, depth + 1, rng, out)) return false;
+    }
+    return true;
+}
+
+// 语料：每行“期望结果 终结符编号... 0”。一半为推导出的句子，一半随机插入/删除一个符号，
+// 期望结果由 LRParser 给出，生成代码必须与之一致
+static QString sentenceCorpus(const Grammar &g, const CompiledTable &table, int count)
+{
+    std::mt19937 rng(20240601);
+    LRParser parser(table);
+    const int T = g.symbols.terminalCount;
+    QString out;
+    QTextStream ts(&out);
+    for (int i = 0; i < count; ++i) {
+        QVector<int> tokens;
+        if (!deriveSentence(g, g.startSymbol, 0, rng, tokens)) continue;
+        if (i % 2 && T > 1) {
+            int pos = rng() % (tokens.size() + 1);
+            if (rng() % 2 && pos < tokens.size()) tokens.remove(pos);
+            else tokens.insert(pos, 1 + int(rng() % (T - 1)));
+        }
+        tokens.append(Grammar::EndMarker);
+        ts << (parser.parse(tokens) ? 1 : 0);
+        for (int t : tokens) ts << ' ' << t;
+        ts << '\n';
+    }
+    return out;
+}
+
+static void generateParsers(const QString &dir, const QString &fileName, const Grammar &base)
+{
+    Grammar g = base;
+    g.computeFirst();
+    g.computeFollow();
+    LRAnalyzer analyzer(g);
+    analyzer.buildMinimalLR1();
+    analyzer.buildLR1Table();
+    CompiledTable table;
+    table.build(analyzer.getLR1ParseTable(), analyzer.getAugmentedGrammar(), analyzer.getLR1States().size());
+
+    const QString name = fileName.section('/', -1).section('.', 0, 0);
+    CodeGenerator tableGen(table, analyzer.getAugmentedGrammar(), name + "_table");
+    CodeGenerator raGen(table, analyzer.getAugmentedGrammar(), name + "_ra");
+    bool ok = writeText(QString("%1/%2_table.h").arg(dir, name), tableGen.tableParserHeader())
+              && writeText(QString("%1/%2_ra.h").arg(dir, name), raGen.recursiveAscentHeader(analyzer.getLR1ParseTable()))
+              && writeText(QString("%1/%2_sentences.txt").arg(dir, name), sentenceCorpus(base, table, 5000));
+    std::printf("%s: %d states, %d conflicts%s\n", qPrintable(name), int(analyzer.getLR1States().size()),
+                int(analyzer.getLR1Conflicts().size()), ok ? "" : " (write failed)");
+}
+
+// 重复分析整个句子集直到累计至少 0.2 秒，返回每秒分析的句子数
+template <typename Parse>
+static double sentencesPerSecond(const QVector<QVector<int>> &sentences, Parse parse)
+{
+    qint64 parsed = 0;
+    int accepted = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        for (const QVector<int> &s : sentences) accepted += parse(s);
+        parsed += sentences.size();
+    } while (timer.nsecsElapsed() < 200000000);
+    if (accepted < 0) std::printf("unreachable\n"); // 防止分析调用被优化掉
+    return parsed * 1e9 / timer.nsecsElapsed();
+}
+
+// 一批句子：一半推导得到，一半随机插入/删除一个符号，均以 # 结尾
+static QVector<QVector<int>> randomSentences(const Grammar &g, int count)
+{
+    std::mt19937 rng(20240601);
+    const int T = g.symbols.terminalCount;
+    QVector<QVector<int>> sentences;
+    for (int i = 0; i < count; ++i) {
+        QVector<int> tokens;
+        if (!deriveSentence(g, g.startSymbol, 0, rng, tokens)) continue;
+        if (i % 2 && T > 1) {
+            int pos = rng() % (tokens.size() + 1);
+            if (rng() % 2 && pos < tokens.size()) tokens.remove(pos);
+            else tokens.insert(pos, 1 + int(rng() % (T - 1)));
+        }
+        tokens.append(Grammar::EndMarker);
+        sentences.append(tokens);
+    }
+    return sentences;
+}
+
+// LL(1) 与 LR 分析驱动的对比：同一批句子先核对两者的接受结果一致，再分别计时。
+// LR 一方用最小 LR(1) 打包表
+static QJsonObject compareParsers(const Grammar &g, const LL1Table &ll, const CompiledTable &lr, int count)
+{
+    const QVector<QVector<int>> sentences = randomSentences(g, count);
+    qint64 tokenCount = 0;
+    for (const QVector<int> &s : sentences) tokenCount += s.size();
+
+    LLParser llParser(ll);
+    LRParser lrParser(lr);
+    int mismatches = 0;
+    for (const QVector<int> &s : sentences) {
+        if (llParser.parse(s) != lrParser.parse(s)) ++mismatches;
+    }
+
+    QJsonObject o;
+    o["sentences"] = int(sentences.size());
+    o["tokens"] = tokenCount;
+    o["mismatches"] = mismatches;
+    o["ll1TableInts"] = ll.denseEntryCount();
+    o["lr1TableInts"] = lr.entryCount();
+    o["ll1SentencesPerSecond"] = sentencesPerSecond(sentences, [&](const QVector<int> &s) { return llParser.parse(s); });
+    o["lr1SentencesPerSecond"] = sentencesPerSecond(sentences, [&](const QVector<int> &s) { return lrParser.parse(s); });
+    return o;
+}
+
+// 优先级声明写回文本：每个层次一行，外加伪符号 PREC_<层次>，供各产生式以 %prec 显式引用
+static QStringList precedenceDeclarations(const Grammar &g)
+{
+    QMap<int, QStringList> names;
+    QMap<int, Precedence::Assoc> assoc;
+    for (int t = 0; t < g.symbols.terminalCount; ++t) {
+        const Precedence prec = g.terminalPrecedence.value(t);
+        if (prec.level == 0) continue;
+        names[prec.level] << g.symbolName(t);
+        assoc[prec.level] = prec.assoc;
+    }
+    for (const Production &p : g.productions) {
+        if (p.precedence != 0) names[p.precedence];
+    }
+    QStringList lines;
+    for (auto it = names.begin(); it != names.end(); ++it) {
+        const Precedence::Assoc a = assoc.value(it.key(), Precedence::Left);
+        const QString kind = a == Precedence::Left ? "%left" : a == Precedence::Right ? "%right" : "%nonassoc";
+        lines << QString("%1 %2 PREC_%3").arg(kind, it.value().join(" ")).arg(it.key()).simplified();
+    }
+    return lines;
+}
+
+static QString precClause(const Production &p)
+{
+    return p.precedence != 0 ? QString(" %prec PREC_%1").arg(p.precedence) : QString();
+}
+
+// 把文法复制 copies 份：S -> t0 A_0 | t1 A_1 | ...，每份的非终结符加后缀 _k
+static QString replicateGrammar(const Grammar &g, int copies)
+{
+    QStringList lines = precedenceDeclarations(g);
+    if (copies <= 1) {
+        for (const Production &p : g.productions) lines << g.productionToString(p.id) + precClause(p);
+        return lines.join("\n");
+    }
+
+    auto rename = [&](int sym, int k) {
+        return g.isNonTerminal(sym) ? QString("%1_%2").arg(g.symbolName(sym)).arg(k) : g.symbolName(sym);
+    };
+
+    QStringList alts;
+    for (int k = 0; k < copies; ++k) {
+        alts << QString("t%1 %2").arg(k).arg(rename(g.startSymbol, k));
+    }
+    lines << QString("S -> %1").arg(alts.join(" | "));
+    for (int k = 0; k < copies; ++k) {
+        for (const Production &p : g.productions) {
+            QStringList rhs;
+            for (int sym : p.right) rhs << rename(sym, k);
+            lines << QString("%1 -> %2%3").arg(rename(p.left, k), rhs.isEmpty() ? g.epsilon : rhs.join(" "), precClause(p));
+        }
+    }
+    return lines.join("\n");
+}
+
+// 一种构造方式的一次测量。items 为内核项目数（LR(1) 按“核心, 向前看符号”对计），
+// cells 为 ACTION/GOTO 中的非空格子数；peakRssKb、allocations 取第一次运行的结果
+struct Measurement {
+    QString mode;
+    int states = 0;
+    qint64 items = 0;
+    int cells = 0;
+    int conflicts = 0;
+    double ms = 0;
+    qint64 peakRssKb = 0;
+    qint64 allocations = 0;
+};
+
+static int tableCells(const LRTable &table)
+{
+    int n = 0;
+    for (const QMap<int, ActionEntry> &row : table.action) n += row.size();
+    for (const QMap<int, int> &row : table.goTo) n += row.size();
+    return n;
+}
+
+static qint64 lr0Items(const LRAnalyzer &analyzer)
+{
+    qint64 n = 0;
+    for (const LR0State &s : analyzer.getLR0States()) n += s.kernel.size();
+    return n;
+}
+
+static qint64 lr1Items(const LRAnalyzer &analyzer)
+{
+    qint64 n = 0;
+    for (const LR1State &s : analyzer.getLR1States()) {
+        for (const TerminalSet &lookaheads : s.kernel) n += lookaheads.count();
+    }
+    return n;
+}
+
+// 每次在新的 LRAnalyzer 上运行 build，共 repeat 次取最短时间；stats 从最后一次的结果中填写规模
+template <typename Build, typename Stats>
+static Measurement measure(const QString &mode, const Grammar &g, int repeat, Build build, Stats stats)
+{
+    Measurement m;
+    m.mode = mode;
+    for (int r = 0; r < repeat; ++r) {
+        LRAnalyzer analyzer(g);
+        resetPeakRss();
+        const qint64 allocationsBefore = allocationCount.load();
+        QElapsedTimer timer;
+        timer.start();
+        build(analyzer);
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (r == 0) {
+            m.allocations = allocationCount.load() - allocationsBefore;
+            m.peakRssKb = peakRssKb();
+            m.ms = ms;
+        }
+        m.ms = qMin(m.ms, ms);
+        if (r == repeat - 1) stats(analyzer, m);
+    }
+    return m;
+}
+
+static QJsonObject toJson(const Measurement &m)
+{
+    QJsonObject o;
+    o["mode"] = m.mode;
+    o["states"] = m.states;
+    o["items"] = m.items;
+    o["cells"] = m.cells;
+    o["conflicts"] = m.conflicts;
+    o["ms"] = m.ms;
+    o["peakRssKb"] = m.peakRssKb;
+    o["allocations"] = m.allocations;
+    return o;
+}
+
+static QJsonObject runOne(const QString &name, int copies, const QString &text, int threads, int repeat, bool printText)
+{
+    QJsonObject result;
+    result["grammar"] = name;
+    result["copies"] = copies;
+    Grammar g;
+    QString error;
+    if (!g.parseFromText(text, error)) {
+        std::printf("%s: %s\n", qPrintable(name), qPrintable(error));
+        result["error"] = error;
+        return result;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const GrammarReduction removed = g.removeUselessSymbols();
+    const double reduceMs = timer.nsecsElapsed() / 1e6;
+    timer.restart();
+    g.computeFirst();
+    g.computeFollow();
+    const double firstFollowMs = timer.nsecsElapsed() / 1e6;
+    result["removedProductions"] = int(removed.productions.size());
+    result["reduceMs"] = reduceMs;
+    result["productions"] = int(g.productions.size());
+    result["terminals"] = g.symbols.terminalCount;
+    result["nonterminals"] = g.symbols.size() - g.symbols.terminalCount;
+    result["firstFollowMs"] = firstFollowMs;
+
+    QVector<Measurement> modes;
+    modes << measure("slr", g, repeat, [](LRAnalyzer &a) {
+        a.buildLR0();
+        a.buildSLRTable();
+    }, [](const LRAnalyzer &a, Measurement &m) {
+        m.states = a.getLR0States().size();
+        m.items = lr0Items(a);
+        m.cells = tableCells(a.getSLRTable());
+        m.conflicts = a.getSLRConflicts().size();
+    });
+    modes << measure("lalr", g, repeat, [](LRAnalyzer &a) {
+        a.buildLR0();
+        a.buildLALRTable();
+    }, [](const LRAnalyzer &a, Measurement &m) {
+        m.states = a.getLR0States().size();
+        m.items = lr0Items(a);
+        m.cells = tableCells(a.getLALRTable());
+        m.conflicts = a.getLALRConflicts().size();
+    });
+
+    auto lr1Stats = [](const LRAnalyzer &a, Measurement &m) {
+        m.states = a.getLR1States().size();
+        m.items = lr1Items(a);
+        m.cells = tableCells(a.getLR1ParseTable());
+        m.conflicts = a.getLR1Conflicts().size();
+    };
+    QVector<LR1State> serialStates;
+    modes << measure("lr1", g, repeat, [](LRAnalyzer &a) {
+        a.buildLR1();
+        a.buildLR1Table();
+    }, [&](const LRAnalyzer &a, Measurement &m) {
+        lr1Stats(a, m);
+        serialStates = a.getLR1States();
+    });
+
+    // 多线程构造：编号确定，应与单线程结果逐状态相同
+    bool same = true;
+    modes << measure(QString("lr1-parallel-%1").arg(threads), g, repeat, [threads](LRAnalyzer &a) {
+        a.buildLR1Parallel(threads);
+        a.buildLR1Table();
+    }, [&](const LRAnalyzer &a, Measurement &m) {
+        lr1Stats(a, m);
+        same = a.getLR1States().size() == serialStates.size();
+        for (int i = 0; same && i < serialStates.size(); ++i) {
+            same = a.getLR1States()[i].kernel == serialStates[i].kernel
+                   && a.getLR1States()[i].transitions == serialStates[i].transitions;
+        }
+    });
+    result["parallelMatchesSerial"] = same;
+
+    // 惰性 LR(1)：构造与分析同一批句子一起计时，states 为实际展开的状态数；
+    // 接受结果应与完整构造的 LR(1) 表一致
+    const QVector<QVector<int>> sentences = randomSentences(g, 2000);
+    bool lazySame = true;
+    modes << measure("lr1-lazy", g, repeat, [&](LRAnalyzer &a) {
+        a.buildLR1Lazy();
+        LazyLRParser parser(a);
+        for (const QVector<int> &s : sentences) parser.parse(s);
+    }, [&](const LRAnalyzer &a, Measurement &m) {
+        m.states = a.lazyExpandedCount();
+        m.items = lr1Items(a);
+        m.cells = tableCells(a.getLR1ParseTable());
+        m.conflicts = a.getLR1Conflicts().size();
+    });
+    {
+        LRAnalyzer full(g), lazy(g);
+        full.buildLR1();
+        full.buildLR1Table();
+        lazy.buildLR1Lazy();
+        CompiledTable table;
+        table.build(full.getLR1ParseTable(), full.getAugmentedGrammar(), full.getLR1States().size());
+        LRParser fullParser(table);
+        LazyLRParser lazyParser(lazy);
+        for (const QVector<int> &s : sentences) lazySame = lazySame && fullParser.parse(s) == lazyParser.parse(s);
+    }
+    result["lazyMatchesFull"] = lazySame;
+
+    modes << measure("minlr1", g, repeat, [](LRAnalyzer &a) {
+        a.buildMinimalLR1();
+        a.buildLR1Table();
+    }, lr1Stats);
+
+    // 由最小 LR(1) 表打包成数组：cells 为打包后的数组长度，只计打包本身的时间
+    LRAnalyzer minimal(g);
+    minimal.buildMinimalLR1();
+    minimal.buildLR1Table();
+    int packedCells = 0;
+    modes << measure("compiled", g, repeat, [&](LRAnalyzer &) {
+        CompiledTable compiled;
+        compiled.build(minimal.getLR1ParseTable(), minimal.getAugmentedGrammar(), minimal.getLR1States().size());
+        packedCells = compiled.entryCount();
+    }, [&](const LRAnalyzer &, Measurement &m) {
+        m.states = minimal.getLR1States().size();
+        m.cells = packedCells;
+    });
+
+    // LL(1) 预测分析表：cells 为非出错格子数
+    LL1Table ll;
+    modes << measure("ll1", g, repeat, [&](LRAnalyzer &) {
+        ll.build(g);
+    }, [&](const LRAnalyzer &, Measurement &m) {
+        m.cells = ll.entryCount();
+        m.conflicts = ll.getConflicts().size();
+    });
+
+    QJsonArray modeArray;
+    for (const Measurement &m : modes) modeArray.append(toJson(m));
+    result["modes"] = modeArray;
+
+    QJsonObject parse;
+    if (ll.isLL1()) {
+        CompiledTable compiled;
+        compiled.build(minimal.getLR1ParseTable(), minimal.getAugmentedGrammar(), minimal.getLR1States().size());
+        parse = compareParsers(g, ll, compiled, 2000);
+        result["parse"] = parse;
+    }
+
+    if (printText) {
+        const QString title = QString("%1 x%2").arg(name).arg(copies);
+        std::printf("%-24s prods %5d | FIRST/FOLLOW %8.3f ms%s\n", qPrintable(title), int(g.productions.size()),
+                    firstFollowMs, same ? (lazySame ? "" : " | lazy LR(1) MISMATCH") : " | parallel LR(1) MISMATCH");
+        for (const Measurement &m : modes) {
+            std::printf("    %-16s %7d states %9lld items %8d cells %4d conflicts %10.2f ms %9lld KB %10lld allocs\n",
+                        qPrintable(m.mode), m.states, (long long)m.items, m.cells, m.conflicts, m.ms,
+                        (long long)m.peakRssKb, (long long)m.allocations);
+        }
+        if (!parse.isEmpty()) {
+            std::printf("    parse %d sentences %lld tokens | mismatches %d | LL(1) %d ints %10.0f sent/s"
+                        " | LR(1) %d ints %10.0f sent/s\n",
+                        parse["sentences"].toInt(), (long long)parse["tokens"].toDouble(), parse["mismatches"].toInt(),
+                        parse["ll1TableInts"].toInt(), parse["ll1SentencesPerSecond"].toDouble(),
+                        parse["lr1TableInts"].toInt(), parse["lr1SentencesPerSecond"].toDouble());
+        }
+        std::fflush(stdout);
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeFirst();
+
+    int maxScale = 1;
+    int threads = QThread::idealThreadCount();
+    int repeat = 1;
+    QString generateDir;
+    QString jsonFile;
+    QStringList files;
+    for (int i = 0; i < args.size(); ++i) {
+        if (args[i] == "--scale" && i + 1 < args.size()) {
+            maxScale = qMax(1, args[++i].toInt());
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = qMax(1, args[++i].toInt());
+        } else if (args[i] == "--repeat" && i + 1 < args.size()) {
+            repeat = qMax(1, args[++i].toInt());
+        } else if (args[i] == "--json" && i + 1 < args.size()) {
+            jsonFile = args[++i];
+        } else if (args[i] == "--generate" && i + 1 < args.size()) {
+            generateDir = args[++i];
+        } else {
+            files << args[i];
+        }
+    }
+    if (files.isEmpty()) {
+        std::printf("usage: lrbench [--scale N] [--threads N] [--repeat N] [--json FILE] grammar.txt...\n"
+                    "       lrbench --generate DIR grammar.txt...\n");
+        return 1;
+    }
+
+    const bool printText = jsonFile != "-";
+    QJsonArray results;
+    for (const QString &fileName : files) {
+        QString text;
+        if (!readText(fileName, text)) {
+            std::printf("%s: cannot open\n", qPrintable(fileName));
+            continue;
+        }
+        Grammar base;
+        QString error;
+        if (!base.parseFromText(text, error)) {
+            std::printf("%s: %s\n", qPrintable(fileName), qPrintable(error));
+            continue;
+        }
+        if (!generateDir.isEmpty()) {
+            generateParsers(generateDir, fileName, base);
+            continue;
+        }
+        for (int k = 1; k <= maxScale; k *= 2) {
+            results.append(runOne(fileName.section('/', -1), k, replicateGrammar(base, k), threads, repeat, printText));
+        }
+    }
+    if (jsonFile.isEmpty()) return 0;
+
+    QJsonObject root;
+    root["threads"] = threads;
+    root["repeat"] = repeat;
+    root["results"] = results;
+    const QByteArray json = QJsonDocument(root).toJson();
+    if (jsonFile == "-") {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+        return 0;
+    }
+    QFile f(jsonFile);
+    if (!f.open(QIODevice::WriteOnly) || f.write(json) != json.size()) {
+        std::printf("%s: cannot write\n", qPrintable(jsonFile));
+        return 1;
+    }
+    return 0;
+}
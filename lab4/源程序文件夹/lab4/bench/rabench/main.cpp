@@ -0,0 +1,109 @@
+// 生成代码基准：同一语料分别用表驱动分析器（<name>_table.h）和递归上升分析器（<name>_ra.h）分析，
+// 先核对两者的接受结果都和语料中 LRParser 给出的期望一致、接受的句子归约序列相同，再分别计时。
+//
+// 用法：rabench [DIR]   DIR 为 lrbench --generate 的输出目录，默认 generated
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "expr_ra.h"
+#include "expr_table.h"
+#include "pascal_ra.h"
+#include "pascal_table.h"
+
+struct Corpus {
+    std::vector<std::vector<int>> sentences; // 均以 0（#）结尾
+    std::vector<bool> expected;
+    long tokenCount = 0;
+};
+
+static bool loadCorpus(const std::string &fileName, Corpus &corpus)
+{
+    std::ifstream in(fileName);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        int expected;
+        if (!(ls >> expected)) continue;
+        std::vector<int> tokens;
+        int t;
+        while (ls >> t) tokens.push_back(t);
+        corpus.tokenCount += long(tokens.size());
+        corpus.sentences.push_back(tokens);
+        corpus.expected.push_back(expected != 0);
+    }
+    return !corpus.sentences.empty();
+}
+
+// 对每个句子比较接受结果，对应接受的句子再比较归约序列，返回不一致的句子数
+template <typename TableParse, typename RaParse>
+static int verify(const Corpus &corpus, TableParse tableParse, RaParse raParse)
+{
+    int mismatches = 0;
+    for (size_t i = 0; i < corpus.sentences.size(); ++i) {
+        const std::vector<int> &s = corpus.sentences[i];
+        std::vector<int> tableReductions, raReductions;
+        size_t p1 = 0, p2 = 0;
+        bool a = tableParse([&] { return s[p1++]; }, [&](int p) { tableReductions.push_back(p); });
+        bool b = raParse([&] { return s[p2++]; }, [&](int p) { raReductions.push_back(p); });
+        // 出错的句子在发现错误前可能已做了不同的默认归约，只比较接受的句子的归约序列
+        if (a != corpus.expected[i] || b != corpus.expected[i]) ++mismatches;
+        else if (corpus.expected[i] && tableReductions != raReductions) ++mismatches;
+    }
+    return mismatches;
+}
+
+// 重复分析整个语料直到累计至少 0.5 秒，返回每秒分析的句子数
+template <typename Parse>
+static double sentencesPerSecond(const Corpus &corpus, Parse parse)
+{
+    using Clock = std::chrono::steady_clock;
+    long parsed = 0;
+    long accepted = 0;
+    const Clock::time_point start = Clock::now();
+    double seconds = 0;
+    do {
+        for (const std::vector<int> &s : corpus.sentences) accepted += parse(s.data());
+        parsed += long(corpus.sentences.size());
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (seconds < 0.5);
+    if (accepted < 0) std::printf("unreachable\n"); // 防止分析调用被优化掉
+    return parsed / seconds;
+}
+
+template <typename TableParse, typename RaParse, typename TableTokens, typename RaTokens>
+static void run(const std::string &dir, const char *name, TableParse tableParse, RaParse raParse,
+                TableTokens tableTokens, RaTokens raTokens)
+{
+    Corpus corpus;
+    if (!loadCorpus(dir + "/" + name + "_sentences.txt", corpus)) {
+        std::printf("%-8s cannot read %s/%s_sentences.txt\n", name, dir.c_str(), name);
+        return;
+    }
+    const int mismatches = verify(corpus, tableParse, raParse);
+    const double tableRate = sentencesPerSecond(corpus, tableTokens);
+    const double raRate = sentencesPerSecond(corpus, raTokens);
+    std::printf("%-8s %6zu sentences %8ld tokens | mismatches %d | table %10.0f sent/s | recursive ascent %10.0f sent/s | x%.2f\n",
+                name, corpus.sentences.size(), corpus.tokenCount, mismatches, tableRate, raRate, raRate / tableRate);
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string dir = argc > 1 ? argv[1] : "generated";
+
+    run(dir, "expr",
+        [](auto &&next, auto &&reduce) { return expr_table::parse(next, reduce); },
+        [](auto &&next, auto &&reduce) { return expr_ra::parse(next, reduce); },
+        [](const int *tokens) { return expr_table::parseTokens(tokens); },
+        [](const int *tokens) { return expr_ra::parseTokens(tokens); });
+    run(dir, "pascal",
+        [](auto &&next, auto &&reduce) { return pascal_table::parse(next, reduce); },
+        [](auto &&next, auto &&reduce) { return pascal_ra::parse(next, reduce); },
+        [](const int *tokens) { return pascal_table::parseTokens(tokens); },
+        [](const int *tokens) { return pascal_ra::parseTokens(tokens); });
+    return 0;
+}
@@ -0,0 +1,13 @@
+# 比较生成的表驱动分析器与递归上升分析器，不依赖 Qt。
+# 构建前先在本目录生成分析器与语料：
+#   lrbench --generate generated ../grammars/expr.txt ../grammars/pascal.txt
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle qt
+
+TARGET = rabench
+
+INCLUDEPATH += $$PWD/generated
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,89 @@
+#include "buildtask.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "tablecache.h"
+
+LR1BuildTask::LR1BuildTask(const Options &options, QObject *parent)
+    : QObject(parent)
+    , opts(options)
+    , grammar(new Grammar)
+{
+}
+
+LR1BuildTask::~LR1BuildTask()
+{
+    if (!thread) return;
+    cancel();
+    thread->wait();
+    delete thread;
+}
+
+void LR1BuildTask::start()
+{
+    thread = QThread::create([this]() { run(); });
+    // 线程结束的信号在本对象所在的线程（界面线程）上处理
+    connect(thread, &QThread::finished, this, &LR1BuildTask::finished);
+    thread->start();
+}
+
+bool LR1BuildTask::isRunning() const
+{
+    return thread && thread->isRunning();
+}
+
+void LR1BuildTask::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!grammar->parseFromText(opts.grammarText, error)) return;
+    removed = grammar->removeUselessSymbols();
+    if (opts.incremental) {
+        grammar->updateFirstFollow(opts.previousGrammar);
+    } else {
+        grammar->computeFirst();
+        grammar->computeFollow();
+    }
+    if (cancelToken.loadRelaxed()) {
+        cancelled = true;
+        return;
+    }
+
+    // LRAnalyzer 持有文法的引用：删除器捕获 grammar，文法与自动机一同释放，
+    // 任务对象先于 previousLR1、表格模型中的拷贝析构也不会留下悬空引用
+    result = QSharedPointer<LRAnalyzer>(new LRAnalyzer(*grammar), [owner = grammar](LRAnalyzer *analyzer) {
+        delete analyzer;
+    });
+    const QString kind = opts.minimal ? "minlr1" : "lr1";
+    QString cacheFile;
+    QByteArray key;
+    if (!opts.grammarFile.isEmpty()) {
+        cacheFile = TableCache::cacheFileName(opts.grammarFile, kind);
+        key = TableCache::grammarKey(*grammar, kind);
+        cacheHit = TableCache::load(cacheFile, key, *result);
+    }
+
+    if (!cacheHit) {
+        qint64 lastReport = -1;
+        result->setBuildMonitor([&](int states, int queued) {
+            const qint64 now = timer.elapsed();
+            if (lastReport >= 0 && now - lastReport < 100) return;
+            lastReport = now;
+            emit progress(states, queued);
+        }, &cancelToken);
+
+        if (opts.minimal) result->buildMinimalLR1();
+        else if (opts.incremental && opts.previous) result->buildLR1Incremental(*opts.previous);
+        else result->buildLR1Parallel();
+        result->setBuildMonitor(nullptr, nullptr);
+
+        cancelled = result->wasCancelled();
+        if (!cancelled) {
+            result->buildLR1Table();
+            if (!cacheFile.isEmpty() && opts.writeCache) TableCache::save(cacheFile, key, *result);
+        }
+    }
+    elapsed = timer.elapsed();
+}
@@ -0,0 +1,69 @@
+#ifndef BUILDTASK_H
+#define BUILDTASK_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+
+#include "grammar.h"
+#include "lr.h"
+
+class QThread;
+
+// 在后台线程中完成一次 LR(1) 构造：解析文法并删去无用符号、求 FIRST/FOLLOW（增量模式下在上一次结果上更新）、
+// 读取缓存或构造规范/最小 LR(1) 自动机并填表，未命中缓存时写回。
+// 构造过程中以 progress 信号报告已发现的状态数与队列长度（限制为约每 100 ms 一次），
+// cancel() 之后在展开下一个状态前停止。无论成功、出错还是取消，结束时都发出 finished。
+class LR1BuildTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString grammarText;
+        bool minimal = false;            // 最小 LR(1)，否则为规范 LR(1)
+        bool incremental = false;        // 在 previousGrammar/previous 上增量更新
+        Grammar previousGrammar;         // 上一次成功解析的文法（已求 FIRST/FOLLOW）
+        QSharedPointer<const LRAnalyzer> previous; // 上一次构造的规范 LR(1) 自动机，可为空
+        QString grammarFile;             // 文法文件名，为空表示不使用缓存
+        bool writeCache = true;
+    };
+
+    explicit LR1BuildTask(const Options &options, QObject *parent = nullptr);
+    ~LR1BuildTask() override; // 取消并等待线程结束
+
+    void start();
+    void cancel() { cancelToken.storeRelaxed(1); }
+    bool isRunning() const;
+
+    // 以下在 finished 之后有效
+    bool wasCancelled() const { return cancelled; }
+    const QString &errorMessage() const { return error; } // 文法有误时非空
+    const Grammar &resultGrammar() const { return *grammar; }
+    const GrammarReduction &reduction() const { return removed; } // 解析后删去的无用符号与产生式
+    QSharedPointer<LRAnalyzer> analyzer() const { return result; } // 同时持有它引用的文法，可比任务活得更久
+    bool fromCache() const { return cacheHit; }
+    qint64 elapsedMs() const { return elapsed; }
+    const Options &options() const { return opts; }
+
+signals:
+    void progress(int states, int queued);
+    void finished();
+
+private:
+    Options opts;
+    QThread *thread = nullptr;
+    QAtomicInt cancelToken{0};
+    QSharedPointer<Grammar> grammar;
+    QSharedPointer<LRAnalyzer> result;
+    QString error;
+    GrammarReduction removed;
+    bool cancelled = false;
+    bool cacheHit = false;
+    qint64 elapsed = 0;
+
+    void run(); // 在工作线程中执行
+};
+
+#endif // BUILDTASK_H
@@ -0,0 +1,21 @@
+# 无界面的批处理工具，只依赖 QtCore
+QT       = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = lab4cli
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../grammar.cpp \
+    ../llparser.cpp \
+    ../lr.cpp \
+    main.cpp
+
+HEADERS += \
+    ../grammar.h \
+    ../llparser.h \
+    ../lr.h \
+    ../terminalset.h
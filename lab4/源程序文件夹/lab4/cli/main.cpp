@@ -0,0 +1,348 @@
+// 文法批处理工具：对多个文法文件求 FIRST/FOLLOW 并构造 SLR(1)、LALR(1)、LR(1)、最小 LR(1) 分析表
+// 与 LL(1) 预测分析表，把分析表、冲突与用时写成 JSON 或 CSV。
+// 不同文件在线程池中并行处理，输出按命令行中的文件顺序排列。
+//
+// 用法：lab4cli [--modes slr,lalr,lr1,minlr1,ll1] [--format json|csv] [--output FILE] [--threads N]
+//               [--no-tables] grammar.txt...
+//   --modes      要构造的分析表，默认全部；ll1 的“状态数”为预测表的行数（非终结符个数）
+//   --format     json（默认）：每个文法一个对象，含 FIRST/FOLLOW、各分析表与冲突；
+//                csv：每个文法每种分析表一行摘要（状态数、格子数、冲突、用时）
+//   --output     输出文件，默认标准输出
+//   --threads    并行处理的文件数，默认为 CPU 核数
+//   --no-tables  JSON 中不写出 ACTION/GOTO 表，只保留摘要与冲突
+// 构造前先删去文法中的无用符号（非产生的与不可达的），JSON 中以 removed 列出删去的内容。
+// 有文件无法读取或文法有误时照常输出其余结果，退出码为 1。
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include <cstdio>
+
+#include "grammar.h"
+#include "llparser.h"
+#include "lr.h"
+
+struct Options {
+    QStringList modes{"slr", "lalr", "lr1", "minlr1", "ll1"};
+    bool csv = false;
+    bool tables = true;
+};
+
+// 一种分析表的摘要，JSON 与 CSV 共用
+struct ModeResult {
+    QString mode;
+    int states = 0;
+    int cells = 0;
+    QStringList conflicts;
+    double ms = 0;
+    QJsonObject table;
+};
+
+struct FileResult {
+    QString fileName;
+    QString error;
+    int productions = 0;
+    int terminals = 0;
+    int nonterminals = 0;
+    double firstFollowMs = 0;
+    GrammarReduction removed;
+    QJsonObject first, follow;
+    QVector<ModeResult> modes;
+};
+
+static QJsonArray symbolNames(const Grammar &g, const TerminalSet &set)
+{
+    QJsonArray names;
+    set.forEach([&](int t) { names.append(g.symbolName(t)); });
+    return names;
+}
+
+// ACTION/GOTO 按状态输出：每个状态一个对象，符号名 -> "s3"/"r2"/"acc" 或目标状态
+static QJsonObject tableToJson(const Grammar &g, const LRTable &table, int stateCount)
+{
+    QJsonArray action, goTo;
+    for (int s = 0; s < stateCount; ++s) {
+        QJsonObject row;
+        const QMap<int, ActionEntry> actions = table.action.value(s);
+        for (auto it = actions.begin(); it != actions.end(); ++it) {
+            const ActionEntry &ae = it.value();
+            if (ae.type == ActionEntry::Shift) row[g.symbolName(it.key())] = QString("s%1").arg(ae.target);
+            else if (ae.type == ActionEntry::Reduce) row[g.symbolName(it.key())] = QString("r%1").arg(ae.target);
+            else if (ae.type == ActionEntry::Accept) row[g.symbolName(it.key())] = "acc";
+            else if (ae.type == ActionEntry::Error) row[g.symbolName(it.key())] = "err";
+        }
+        action.append(row);
+
+        QJsonObject gotoRow;
+        const QMap<int, int> gotos = table.goTo.value(s);
+        for (auto it = gotos.begin(); it != gotos.end(); ++it) gotoRow[g.symbolName(it.key())] = it.value();
+        goTo.append(gotoRow);
+    }
+    QJsonArray productions;
+    for (const Production &p : g.productions) productions.append(g.productionToString(p.id));
+
+    QJsonObject result;
+    result["productions"] = productions; // 归约动作 rN 中的 N 为这里的下标（增广文法）
+    result["action"] = action;
+    result["goto"] = goTo;
+    return result;
+}
+
+// 预测分析表按非终结符输出：非终结符 -> { 终结符 -> 产生式编号 }
+static QJsonObject ll1TableToJson(const Grammar &g, const LL1Table &table)
+{
+    QJsonObject rows;
+    for (int A = g.symbols.terminalCount; A < g.symbols.size(); ++A) {
+        QJsonObject row;
+        for (int t = 0; t < g.symbols.terminalCount; ++t) {
+            const int prodId = table.predict(A, t);
+            if (prodId >= 0) row[g.symbolName(t)] = prodId;
+        }
+        rows[g.symbolName(A)] = row;
+    }
+    QJsonArray productions;
+    for (const Production &p : g.productions) productions.append(g.productionToString(p.id));
+
+    QJsonObject result;
+    result["productions"] = productions; // 未增广
+    result["predict"] = rows;
+    return result;
+}
+
+static int tableCells(const LRTable &table)
+{
+    int n = 0;
+    for (const QMap<int, ActionEntry> &row : table.action) n += row.size();
+    for (const QMap<int, int> &row : table.goTo) n += row.size();
+    return n;
+}
+
+static ModeResult summarize(const QString &mode, const LRAnalyzer &analyzer, const LRTable &table, int stateCount,
+                            const QList<ConflictInfo> &conflicts, double ms, bool withTable)
+{
+    ModeResult r;
+    r.mode = mode;
+    r.states = stateCount;
+    r.cells = tableCells(table);
+    for (const ConflictInfo &c : conflicts) r.conflicts << c.description;
+    r.ms = ms;
+    if (withTable) r.table = tableToJson(analyzer.getAugmentedGrammar(), table, stateCount);
+    return r;
+}
+
+static void processFile(const QString &fileName, const Options &options, FileResult &result)
+{
+    result.fileName = fileName;
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        result.error = QObject::tr("无法打开文件");
+        return;
+    }
+    QTextStream in(&f);
+    Grammar g;
+    QString error;
+    if (!g.parseFromText(in.readAll(), error)) {
+        result.error = error;
+        return;
+    }
+    result.removed = g.removeUselessSymbols();
+
+    QElapsedTimer timer;
+    timer.start();
+    g.computeFirst();
+    g.computeFollow();
+    result.firstFollowMs = timer.nsecsElapsed() / 1e6;
+    result.productions = g.productions.size();
+    result.terminals = g.symbols.terminalCount;
+    result.nonterminals = g.symbols.size() - g.symbols.terminalCount;
+    for (int A = g.symbols.terminalCount; A < g.symbols.size(); ++A) {
+        result.first[g.symbolName(A)] = symbolNames(g, g.first[A]);
+        result.follow[g.symbolName(A)] = symbolNames(g, g.follow[A]);
+    }
+
+    LRAnalyzer analyzer(g);
+    for (const QString &mode : options.modes) {
+        timer.restart();
+        if (mode == "slr") {
+            analyzer.buildLR0();
+            analyzer.buildSLRTable();
+            result.modes << summarize(mode, analyzer, analyzer.getSLRTable(), analyzer.getLR0States().size(),
+                                      analyzer.getSLRConflicts(), timer.nsecsElapsed() / 1e6, options.tables);
+        } else if (mode == "lalr") {
+            analyzer.buildLR0();
+            analyzer.buildLALRTable();
+            result.modes << summarize(mode, analyzer, analyzer.getLALRTable(), analyzer.getLR0States().size(),
+                                      analyzer.getLALRConflicts(), timer.nsecsElapsed() / 1e6, options.tables);
+        } else if (mode == "lr1" || mode == "minlr1") {
+            // 文件之间已经并行，单个文法用单线程构造
+            if (mode == "lr1") analyzer.buildLR1();
+            else analyzer.buildMinimalLR1();
+            analyzer.buildLR1Table();
+            result.modes << summarize(mode, analyzer, analyzer.getLR1ParseTable(), analyzer.getLR1States().size(),
+                                      analyzer.getLR1Conflicts(), timer.nsecsElapsed() / 1e6, options.tables);
+        } else if (mode == "ll1") {
+            LL1Table table;
+            table.build(g);
+            ModeResult r;
+            r.mode = mode;
+            r.states = g.symbols.nonTerminalCount();
+            r.cells = table.entryCount();
+            for (const ConflictInfo &c : table.getConflicts()) r.conflicts << c.description;
+            r.ms = timer.nsecsElapsed() / 1e6;
+            if (options.tables) r.table = ll1TableToJson(g, table);
+            result.modes << r;
+        }
+    }
+}
+
+static QJsonObject toJson(const FileResult &r)
+{
+    QJsonObject o;
+    o["file"] = r.fileName;
+    if (!r.error.isEmpty()) {
+        o["error"] = r.error;
+        return o;
+    }
+    o["productions"] = r.productions;
+    o["terminals"] = r.terminals;
+    o["nonterminals"] = r.nonterminals;
+    o["firstFollowMs"] = r.firstFollowMs;
+    if (!r.removed.isEmpty()) {
+        QJsonObject removed;
+        removed["unproductive"] = QJsonArray::fromStringList(r.removed.unproductive);
+        removed["unreachable"] = QJsonArray::fromStringList(r.removed.unreachable);
+        removed["productions"] = QJsonArray::fromStringList(r.removed.productions);
+        o["removed"] = removed;
+    }
+    o["first"] = r.first;
+    o["follow"] = r.follow;
+    QJsonArray modes;
+    for (const ModeResult &m : r.modes) {
+        QJsonObject mo;
+        mo["mode"] = m.mode;
+        mo["states"] = m.states;
+        mo["cells"] = m.cells;
+        mo["conflicts"] = QJsonArray::fromStringList(m.conflicts);
+        mo["ms"] = m.ms;
+        if (!m.table.isEmpty()) mo["table"] = m.table;
+        modes.append(mo);
+    }
+    o["modes"] = modes;
+    return o;
+}
+
+// RFC 4180：含逗号、引号或换行的字段加引号，内部引号写两遍
+static QString csvField(const QString &s)
+{
+    if (!s.contains(',') && !s.contains('"') && !s.contains('\n')) return s;
+    QString quoted = s;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+static QString toCsv(const QVector<FileResult> &results)
+{
+    QString out;
+    QTextStream ts(&out);
+    ts << "file,productions,mode,states,cells,conflicts,ms,error,conflict_details\n";
+    for (const FileResult &r : results) {
+        if (!r.error.isEmpty()) {
+            ts << csvField(r.fileName) << ",,,,,,," << csvField(r.error) << ",\n";
+            continue;
+        }
+        ts << csvField(r.fileName) << ',' << r.productions << ",first-follow,,,," << r.firstFollowMs << ",,\n";
+        for (const ModeResult &m : r.modes) {
+            ts << csvField(r.fileName) << ',' << r.productions << ',' << m.mode << ',' << m.states << ','
+               << m.cells << ',' << m.conflicts.size() << ',' << m.ms << ",," << csvField(m.conflicts.join("; ")) << '\n';
+        }
+    }
+    return out;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeFirst();
+
+    Options options;
+    QString outputFile;
+    int threads = QThreadPool::globalInstance()->maxThreadCount();
+    QStringList files;
+    for (int i = 0; i < args.size(); ++i) {
+        if (args[i] == "--modes" && i + 1 < args.size()) {
+            options.modes = args[++i].split(',', Qt::SkipEmptyParts);
+        } else if (args[i] == "--format" && i + 1 < args.size()) {
+            const QString format = args[++i];
+            if (format != "json" && format != "csv") {
+                std::fprintf(stderr, "unknown format: %s (expected json or csv)\n", qPrintable(format));
+                return 2;
+            }
+            options.csv = format == "csv";
+        } else if (args[i] == "--output" && i + 1 < args.size()) {
+            outputFile = args[++i];
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = qMax(1, args[++i].toInt());
+        } else if (args[i] == "--no-tables") {
+            options.tables = false;
+        } else {
+            files << args[i];
+        }
+    }
+    for (const QString &mode : options.modes) {
+        if (mode != "slr" && mode != "lalr" && mode != "lr1" && mode != "minlr1" && mode != "ll1") {
+            std::fprintf(stderr, "unknown mode: %s\n", qPrintable(mode));
+            return 2;
+        }
+    }
+    if (files.isEmpty()) {
+        std::fprintf(stderr, "usage: lab4cli [--modes slr,lalr,lr1,minlr1,ll1] [--format json|csv] [--output FILE]\n"
+                             "               [--threads N] [--no-tables] grammar.txt...\n");
+        return 2;
+    }
+
+    // 每个任务只写自己的那一项，结果按输入顺序输出
+    QVector<FileResult> results(files.size());
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int i = 0; i < files.size(); ++i) {
+        pool.start([&, i]() { processFile(files[i], options, results[i]); });
+    }
+    pool.waitForDone();
+
+    QByteArray output;
+    if (options.csv) {
+        output = toCsv(results).toUtf8();
+    } else {
+        QJsonArray array;
+        for (const FileResult &r : results) array.append(toJson(r));
+        QJsonObject root;
+        root["results"] = array;
+        output = QJsonDocument(root).toJson();
+    }
+
+    if (outputFile.isEmpty()) {
+        std::fwrite(output.constData(), 1, output.size(), stdout);
+    } else {
+        QFile f(outputFile);
+        if (!f.open(QIODevice::WriteOnly) || f.write(output) != output.size()) {
+            std::fprintf(stderr, "%s: cannot write\n", qPrintable(outputFile));
+            return 1;
+        }
+    }
+
+    bool failed = false;
+    for (const FileResult &r : results) {
+        if (!r.error.isEmpty()) {
+            std::fprintf(stderr, "%s: %s\n", qPrintable(r.fileName), qPrintable(r.error));
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,356 @@
+#include "codegen.h"
+
+#include <QSet>
+#include <QStringList>
+
+// 常见单字符终结符在枚举名中的写法
+static QString punctuationName(QChar ch)
+{
+    switch (ch.unicode()) {
+    case '+': return "PLUS";
+    case '-': return "MINUS";
+    case '*': return "STAR";
+    case '/': return "SLASH";
+    case '%': return "PERCENT";
+    case '(': return "LPAREN";
+    case ')': return "RPAREN";
+    case '[': return "LBRACKET";
+    case ']': return "RBRACKET";
+    case '{': return "LBRACE";
+    case '}': return "RBRACE";
+    case ';': return "SEMI";
+    case ',': return "COMMA";
+    case '.': return "DOT";
+    case ':': return "COLON";
+    case '=': return "EQ";
+    case '<': return "LT";
+    case '>': return "GT";
+    case '!': return "BANG";
+    case '&': return "AMP";
+    case '^': return "CARET";
+    case '~': return "TILDE";
+    case '?': return "QUESTION";
+    case '\'': return "PRIME";
+    default: return QString();
+    }
+}
+
+// 符号名转为 C++ 标识符；含无法表示的字符时返回空串
+static QString identifierFor(const QString &symbol)
+{
+    QString id;
+    for (QChar ch : symbol) {
+        const ushort c = ch.unicode();
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_') {
+            id.append(ch);
+            continue;
+        }
+        QString word = punctuationName(ch);
+        if (word.isEmpty()) return QString();
+        if (!id.isEmpty()) id.append('_');
+        id.append(word);
+    }
+    return id;
+}
+
+static QString cppString(const QString &s)
+{
+    QString out = "\"";
+    for (QChar ch : s) {
+        if (ch == '"' || ch == '\\') out.append('\\');
+        out.append(ch);
+    }
+    out.append('"');
+    return out;
+}
+
+// inline constexpr 数组；元素都能放进 16 位时用 int16_t，减小生成文件和目标代码的体积
+static QString intArray(const QString &name, const QVector<int> &values)
+{
+    bool small = true;
+    for (int v : values) {
+        if (v < -32768 || v > 32767) {
+            small = false;
+            break;
+        }
+    }
+    QString out = QString("inline constexpr std::%1 %2[] = {").arg(small ? "int16_t" : "int32_t", name);
+    if (values.isEmpty()) return out + "0};\n";
+    for (int i = 0; i < values.size(); ++i) {
+        if (i % 16 == 0) out += "\n    ";
+        out += QString::number(values[i]);
+        if (i + 1 < values.size()) out += (i % 16 == 15) ? "," : ", ";
+    }
+    return out + "\n};\n";
+}
+
+CodeGenerator::CodeGenerator(const CompiledTable &table, const Grammar &augG, const QString &name)
+    : table(table)
+    , g(augG)
+    , name(identifierFor(name).isEmpty() ? QString("lrparser") : identifierFor(name))
+{
+    QSet<QString> used;
+    identifiers.resize(g.symbols.size());
+    for (int sym = 0; sym < g.symbols.size(); ++sym) {
+        QString prefix = g.isTerminal(sym) ? "T_" : "N_";
+        QString body = sym == Grammar::EndMarker ? QString("END") : identifierFor(g.symbolName(sym));
+        if (body.isEmpty()) body = QString::number(sym);
+        QString id = prefix + body;
+        if (used.contains(id)) id += QString("_%1").arg(sym);
+        used.insert(id);
+        identifiers[sym] = id;
+    }
+}
+
+QString CodeGenerator::headerBegin(const QString &guardSuffix, const QString &description) const
+{
+    const QString guard = QString("%1_%2_H").arg(name.toUpper(), guardSuffix);
+    QString out;
+    out += QString("// 由 lab4 LR 分析器生成的%1，请勿手工修改。\n").arg(description);
+    out += "// 文法：\n";
+    for (const Production &p : g.productions) {
+        out += QString("//   %1: %2\n").arg(p.id).arg(g.productionToString(p.id));
+    }
+    out += QString("#ifndef %1\n#define %1\n\n").arg(guard);
+    out += "#include <cstdint>\n#include <vector>\n\n";
+    out += QString("namespace %1 {\n\n").arg(name);
+    return out;
+}
+
+QString CodeGenerator::symbolEnums() const
+{
+    QString out = "// 终结符编号，T_END 为结束符 #\nenum Terminal : int {\n";
+    for (int t = 0; t < g.symbols.terminalCount; ++t) {
+        out += QString("    %1 = %2, // %3\n").arg(identifiers[t]).arg(t).arg(g.symbolName(t));
+    }
+    out += "};\n\nenum NonTerminal : int {\n";
+    for (int nt = g.symbols.terminalCount; nt < g.symbols.size(); ++nt) {
+        out += QString("    %1 = %2, // %3\n").arg(identifiers[nt]).arg(nt).arg(g.symbolName(nt));
+    }
+    out += "};\n\n";
+    out += QString("inline constexpr int kTerminalCount = %1;\n").arg(g.symbols.terminalCount);
+    out += QString("inline constexpr int kSymbolCount = %1;\n").arg(g.symbols.size());
+    out += QString("inline constexpr int kStateCount = %1;\n").arg(table.getStateCount());
+    out += QString("inline constexpr int kProductionCount = %1;\n\n").arg(g.productions.size());
+
+    QStringList names;
+    for (int sym = 0; sym < g.symbols.size(); ++sym) names << cppString(g.symbolName(sym));
+    out += QString("inline constexpr const char *symbolNames[] = {%1};\n\n").arg(names.join(", "));
+    return out;
+}
+
+QString CodeGenerator::productionArrays() const
+{
+    QVector<int> lengths, lefts;
+    for (const Production &p : g.productions) {
+        lengths.append(table.productionLength(p.id));
+        lefts.append(table.productionLeft(p.id));
+    }
+    return "// 产生式右部长度与左部符号，按产生式编号索引\n"
+           + intArray("productionLength", lengths) + intArray("productionLeft", lefts) + "\n";
+}
+
+QString CodeGenerator::tableParserHeader() const
+{
+    QString out = headerBegin("TABLES", "表驱动分析器");
+    out += symbolEnums();
+    out += productionArrays();
+
+    out += "// 动作编码：0 出错，>0 移进到状态 v-1，<0 按产生式 -v-1 归约，kAccept 接受\n";
+    out += "inline constexpr std::int32_t kAccept = INT32_MIN;\n\n";
+    out += "// ACTION/GOTO 为行位移压缩表：第 s 行第 c 列位于 base[s]+c，check 不等于 s 时取默认值\n";
+    out += intArray("actionBase", table.actionBase);
+    out += intArray("actionCheck", table.actionCheck);
+    out += intArray("actionValue", table.actionValue);
+    out += intArray("defaultAction", table.defaultAction);
+    out += intArray("gotoBase", table.gotoBase);
+    out += intArray("gotoCheck", table.gotoCheck);
+    out += intArray("gotoValue", table.gotoValue);
+    out += intArray("defaultGoto", table.defaultGoto);
+    out += "\n";
+
+    out += R"(constexpr int action(int state, int terminal)
+{
+    const int i = actionBase[state] + terminal;
+    return actionCheck[i] == state ? actionValue[i] : defaultAction[state];
+}
+
+// nonTerminal 为符号编号（NonTerminal 枚举值）
+constexpr int goTo(int state, int nonTerminal)
+{
+    const int n = nonTerminal - kTerminalCount;
+    const int i = gotoBase[state] + n;
+    return gotoCheck[i] == state ? gotoValue[i] : defaultGoto[n];
+}
+
+// 分析驱动。next() 依次返回终结符编号，输入结束时返回 T_END；
+// 每次归约调用 reduce(产生式编号)，可在其中构造语法树或求值。
+// 返回句子是否被接受。
+template <typename Next, typename Reduce>
+bool parse(Next &&next, Reduce &&reduce)
+{
+    std::vector<int> stack;
+    stack.reserve(256);
+    stack.push_back(0);
+    int a = next();
+    for (;;) {
+        const int act = action(stack.back(), a);
+        if (act > 0) {
+            stack.push_back(act - 1);
+            a = next();
+        } else if (act == kAccept) {
+            return true;
+        } else if (act < 0) {
+            const int p = -act - 1;
+            stack.resize(stack.size() - productionLength[p]);
+            reduce(p);
+            stack.push_back(goTo(stack.back(), productionLeft[p]));
+        } else {
+            return false;
+        }
+    }
+}
+
+template <typename Next>
+bool parse(Next &&next)
+{
+    return parse(next, [](int) {});
+}
+
+// 分析以 T_END 结尾的终结符序列
+inline bool parseTokens(const int *tokens)
+{
+    return parse([&tokens]() { return *tokens++; });
+}
+
+)";
+    out += QString("} // namespace %1\n\n#endif\n").arg(name);
+    return out;
+}
+
+QString CodeGenerator::recursiveAscentHeader(const LRTable &lrTable) const
+{
+    QString out = headerBegin("RA", "递归上升分析器");
+    out += symbolEnums();
+    out += productionArrays();
+
+    out += R"(namespace ra_detail {
+
+// 状态函数的返回值：>=0 为还需向上返回的层数（为 0 时由当前状态按 lhs 执行 goto），
+// 负数表示接受或出错，沿调用链直接返回
+inline constexpr int kAccept = -1;
+inline constexpr int kError = -2;
+
+template <typename Next, typename Reduce>
+struct Context {
+    Next &next;
+    Reduce &reduce;
+    int la;  // 向前看终结符
+    int lhs; // 最近一次归约得到的非终结符
+};
+
+)";
+
+    const int stateCount = table.getStateCount();
+    for (int s = 0; s < stateCount; ++s) {
+        out += QString("template <typename C> int s%1(C &c);\n").arg(s);
+    }
+    out += "\n";
+
+    for (int s = 0; s < stateCount; ++s) {
+        const QMap<int, ActionEntry> actions = lrTable.action.value(s);
+        const QMap<int, int> gotos = lrTable.goTo.value(s);
+
+        // 最常见的归约作为 default 分支；其余动作按目标合并 case 标签
+        QMap<int, int> reduceCounts;
+        for (const ActionEntry &ae : actions) {
+            if (ae.type == ActionEntry::Reduce) ++reduceCounts[ae.target];
+        }
+        const int defaultProd = CompiledTable::defaultReduction(reduceCounts); // 与表驱动分析器相同
+
+        QMap<QPair<int, int>, QStringList> caseGroups; // (类型, 目标) -> case 标签
+        for (auto it = actions.begin(); it != actions.end(); ++it) {
+            const ActionEntry &ae = it.value();
+            if (ae.type == ActionEntry::Reduce && ae.target == defaultProd) continue;
+            caseGroups[qMakePair(int(ae.type), ae.target)] << QString("case %1:").arg(identifiers[it.key()]);
+        }
+
+        bool needsGoto = false; // 是否有分支在本状态内继续（移进后返回、空产生式归约）
+        auto reduceCode = [&](int prodId) {
+            const Production &p = g.productions[prodId];
+            QString code = QString("c.reduce(%1); c.lhs = %2; ").arg(prodId).arg(identifiers[p.left]);
+            // 空产生式不弹栈，由本状态直接执行 goto
+            if (p.right.isEmpty()) {
+                needsGoto = true;
+                return code + "r = 0; break;";
+            }
+            return code + QString("return %1;").arg(p.right.size() - 1);
+        };
+
+        QString body;
+        for (auto it = caseGroups.begin(); it != caseGroups.end(); ++it) {
+            const int type = it.key().first;
+            const int target = it.key().second;
+            QString code;
+            if (type == ActionEntry::Shift) {
+                needsGoto = true;
+                code = QString("c.la = c.next(); r = s%1(c); break;").arg(target);
+            } else if (type == ActionEntry::Reduce) {
+                code = reduceCode(target);
+            } else if (type == ActionEntry::Error) {
+                code = "return kError;"; // %nonassoc，不能落入默认归约
+            } else {
+                code = "return kAccept;";
+            }
+            body += QString("    %1\n        %2\n").arg(it.value().join(" "), code);
+        }
+        body += QString("    default:\n        %1\n    }\n").arg(defaultProd >= 0 ? reduceCode(defaultProd) : QString("return kError;"));
+
+        out += QString("template <typename C> int s%1(C &c)\n{\n").arg(s);
+        if (needsGoto) out += "    int r;\n";
+        out += "    switch (c.la) {\n" + body;
+        if (!needsGoto) {
+            out += "}\n\n";
+            continue;
+        }
+        out += "    for (;;) {\n        if (r != 0) return r > 0 ? r - 1 : r;\n";
+        if (gotos.isEmpty()) {
+            out += "        return kError;\n";
+        } else {
+            out += "        switch (c.lhs) {\n";
+            for (auto it = gotos.begin(); it != gotos.end(); ++it) {
+                out += QString("        case %1: r = s%2(c); break;\n").arg(identifiers[it.key()]).arg(it.value());
+            }
+            out += "        default: return kError;\n        }\n";
+        }
+        out += "    }\n}\n\n";
+    }
+    out += "} // namespace ra_detail\n\n";
+
+    out += R"(// 分析驱动，接口与表驱动版本相同：next() 依次返回终结符编号（结束时返回 T_END），
+// 每次归约调用 reduce(产生式编号)。分析栈即 C++ 调用栈，深度与分析栈深度相同
+template <typename Next, typename Reduce>
+bool parse(Next &&next, Reduce &&reduce)
+{
+    ra_detail::Context<Next, Reduce> c{next, reduce, 0, -1};
+    c.la = next();
+    return ra_detail::s0(c) == ra_detail::kAccept;
+}
+
+template <typename Next>
+bool parse(Next &&next)
+{
+    auto ignore = [](int) {};
+    return parse(next, ignore);
+}
+
+// 分析以 T_END 结尾的终结符序列
+inline bool parseTokens(const int *tokens)
+{
+    return parse([&tokens]() { return *tokens++; });
+}
+
+)";
+    out += QString("} // namespace %1\n\n#endif\n").arg(name);
+    return out;
+}
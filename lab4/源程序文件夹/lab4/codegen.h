@@ -0,0 +1,37 @@
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include "compiledtable.h"
+#include "grammar.h"
+#include <QString>
+#include <QVector>
+
+// 分析器代码生成：把 CompiledTable 导出为不依赖 Qt 的 C++ 头文件，
+// 下游程序直接包含即可分析，无需在运行时构造分析表。
+class CodeGenerator
+{
+public:
+    // augG 为构造 table 时使用的增广文法；name 为生成代码的命名空间
+    CodeGenerator(const CompiledTable &table, const Grammar &augG, const QString &name);
+
+    // 表驱动分析器：constexpr 的 ACTION/GOTO（行位移压缩形式）、产生式长度与左部、
+    // 符号枚举以及模板化的分析驱动
+    QString tableParserHeader() const;
+
+    // 递归上升分析器：每个状态生成一个函数，按向前看终结符 switch；
+    // 归约调用回调后返回还需弹出的层数，由相应的调用者执行 goto。
+    // lrTable 提供各状态确切的 goto 集合（CompiledTable 中它们可能被默认值替代）
+    QString recursiveAscentHeader(const LRTable &lrTable) const;
+
+private:
+    const CompiledTable &table;
+    const Grammar &g;
+    QString name;
+    QVector<QString> identifiers; // 符号编号 -> 生成代码中的枚举名
+
+    QString headerBegin(const QString &guardSuffix, const QString &description) const;
+    QString symbolEnums() const;
+    QString productionArrays() const;
+};
+
+#endif // CODEGEN_H
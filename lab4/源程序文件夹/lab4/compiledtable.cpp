@@ -0,0 +1,161 @@
+#include "compiledtable.h"
+
+#include <QMap>
+#include <algorithm>
+
+// 把若干稀疏行打包进 check/value 数组，返回每行的起始位置 base。
+// 压缩时按“先放长行、首次适配”的方式为每行找一个与已放入格子不冲突的位移；
+// 空行不写入任何格子，base 取 0 即可（check 中不会出现它的行号）。
+static void packRows(const QVector<QVector<QPair<int, int>>> &rows, int columnCount, bool compress,
+                     QVector<int> &base, QVector<int> &check, QVector<int> &value)
+{
+    const int rowCount = rows.size();
+    base = QVector<int>(rowCount, 0);
+    check.clear();
+    value.clear();
+
+    if (!compress) {
+        check = QVector<int>(rowCount * columnCount, -1);
+        value = QVector<int>(rowCount * columnCount, 0);
+        for (int r = 0; r < rowCount; ++r) {
+            base[r] = r * columnCount;
+            for (const QPair<int, int> &cell : rows[r]) {
+                check[base[r] + cell.first] = r;
+                value[base[r] + cell.first] = cell.second;
+            }
+        }
+        return;
+    }
+
+    QVector<int> order(rowCount);
+    for (int r = 0; r < rowCount; ++r) order[r] = r;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return rows[a].size() > rows[b].size(); });
+
+    int firstFree = 0; // 此前的格子都已占用
+    for (int r : order) {
+        const QVector<QPair<int, int>> &row = rows[r];
+        if (row.isEmpty()) break;
+
+        int b = qMax(0, firstFree - row.first().first);
+        for (;; ++b) {
+            bool fits = true;
+            for (const QPair<int, int> &cell : row) {
+                int i = b + cell.first;
+                if (i < check.size() && check[i] != -1) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits) break;
+        }
+
+        base[r] = b;
+        for (const QPair<int, int> &cell : row) {
+            int i = b + cell.first;
+            if (i >= check.size()) {
+                check.resize(i + 1, -1);
+                value.resize(i + 1, 0);
+            }
+            check[i] = r;
+            value[i] = cell.second;
+        }
+        while (firstFree < check.size() && check[firstFree] != -1) ++firstFree;
+    }
+
+    // 保证任何一行的 base + 列号 都不越界
+    int maxBase = 0;
+    for (int b : base) maxBase = qMax(maxBase, b);
+    if (check.size() < maxBase + columnCount) {
+        check.resize(maxBase + columnCount, -1);
+        value.resize(maxBase + columnCount, 0);
+    }
+}
+
+// 出现次数最多的键；次数相同取键最小者（QMap 按键升序遍历，只在严格更多时替换），保证结果与插入顺序无关
+static int mostFrequent(const QMap<int, int> &counts, int fallback)
+{
+    int best = fallback;
+    int bestCount = 0;
+    for (auto it = counts.begin(); it != counts.end(); ++it) {
+        if (it.value() > bestCount) {
+            best = it.key();
+            bestCount = it.value();
+        }
+    }
+    return best;
+}
+
+int CompiledTable::defaultReduction(const QMap<int, int> &reduceCounts)
+{
+    return mostFrequent(reduceCounts, -1);
+}
+
+void CompiledTable::build(const LRTable &table, const Grammar &augG, int stateCount, const Options &options)
+{
+    this->stateCount = stateCount;
+    terminalCount = augG.symbols.terminalCount;
+    symbolCount = augG.symbols.size();
+    const int nonTerminalCount = symbolCount - terminalCount;
+
+    prodLength.resize(augG.productions.size());
+    prodLeft.resize(augG.productions.size());
+    for (const Production &p : augG.productions) {
+        prodLength[p.id] = p.right.size();
+        prodLeft[p.id] = p.left;
+    }
+
+    // ACTION：编码每一格，再把最常见的归约提出来作为该行默认动作。
+    // 默认归约只会让出错的发现推迟到下一次移进之前，不影响句子是否被接受
+    QVector<QVector<QPair<int, int>>> actionRows(stateCount);
+    defaultAction = QVector<int>(stateCount, Error);
+    for (int s = 0; s < stateCount; ++s) {
+        QVector<QPair<int, int>> &row = actionRows[s];
+        QMap<int, int> reduceCounts; // 产生式 -> 格子数
+        auto sit = table.action.find(s);
+        if (sit != table.action.end()) {
+            for (auto it = sit.value().begin(); it != sit.value().end(); ++it) {
+                const ActionEntry &ae = it.value();
+                int code = Error;
+                if (ae.type == ActionEntry::Shift) code = encodeShift(ae.target);
+                else if (ae.type == ActionEntry::Reduce) code = encodeReduce(ae.target);
+                else if (ae.type == ActionEntry::Accept) code = Accept;
+                // %nonassoc 的出错格照样写入，使 check 命中而不落到默认归约
+                if (code == Error && ae.type != ActionEntry::Error) continue;
+                row.append(qMakePair(it.key(), code));
+                if (isReduce(code)) ++reduceCounts[ae.target];
+            }
+        }
+        if (options.defaultReductions && !reduceCounts.isEmpty()) {
+            const int def = encodeReduce(defaultReduction(reduceCounts));
+            defaultAction[s] = def;
+            row.erase(std::remove_if(row.begin(), row.end(),
+                                     [def](const QPair<int, int> &cell) { return cell.second == def; }),
+                      row.end());
+        }
+    }
+    packRows(actionRows, terminalCount, options.compress, actionBase, actionCheck, actionValue);
+
+    // GOTO：列为非终结符（编号减去终结符个数），每列最常见的目标作为默认值。
+    // 分析时只会查合法的 goto，所以默认值不会被误用
+    QVector<QVector<QPair<int, int>>> gotoRows(stateCount);
+    QVector<QMap<int, int>> targetCounts(nonTerminalCount);
+    for (auto sit = table.goTo.begin(); sit != table.goTo.end(); ++sit) {
+        if (sit.key() >= stateCount) continue;
+        for (auto it = sit.value().begin(); it != sit.value().end(); ++it) {
+            gotoRows[sit.key()].append(qMakePair(it.key() - terminalCount, it.value()));
+            ++targetCounts[it.key() - terminalCount][it.value()];
+        }
+    }
+    defaultGoto = QVector<int>(nonTerminalCount, -1);
+    if (options.defaultReductions) {
+        for (int n = 0; n < nonTerminalCount; ++n) {
+            defaultGoto[n] = mostFrequent(targetCounts[n], -1);
+        }
+        for (QVector<QPair<int, int>> &row : gotoRows) {
+            row.erase(std::remove_if(row.begin(), row.end(),
+                                     [&](const QPair<int, int> &cell) { return cell.second == defaultGoto[cell.first]; }),
+                      row.end());
+        }
+    }
+    packRows(gotoRows, nonTerminalCount, options.compress, gotoBase, gotoCheck, gotoValue);
+}
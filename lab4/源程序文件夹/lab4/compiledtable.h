@@ -0,0 +1,76 @@
+#ifndef COMPILEDTABLE_H
+#define COMPILEDTABLE_H
+
+#include "grammar.h"
+#include "lr.h"
+#include <QMap>
+#include <QVector>
+#include <climits>
+
+// 编译后的 LR 分析表：把 LRTable 的嵌套 QMap 压成整数数组，供分析驱动使用。
+//
+// 动作打包为一个 int：0 为出错，>0 为移进到状态 (v-1)，<0 为按产生式 (-v-1) 归约，
+// Accept 单独取 INT_MIN。
+// ACTION/GOTO 都按行位移（comb vector）存放：第 s 行的第 c 列位于
+// value[base[s] + c]，当且仅当 check[base[s] + c] == s 时有效，否则取该行/列的默认值。
+// 不压缩时 base[s] = s * 列数，就是普通的稠密二维数组，查表代码完全相同。
+class CompiledTable
+{
+public:
+    enum : int { Error = 0, Accept = INT_MIN };
+
+    static int encodeShift(int state) { return state + 1; }
+    static int encodeReduce(int prodId) { return -prodId - 1; }
+    static bool isShift(int a) { return a > 0; }
+    static bool isReduce(int a) { return a < 0 && a != Accept; }
+    static int shiftTarget(int a) { return a - 1; }
+    static int reduceProduction(int a) { return -a - 1; }
+
+    // 一行的默认归约：reduceCounts 为 产生式 -> 该行按它归约的格子数，取次数最多者，
+    // 次数相同时取产生式编号最小者；没有归约时为 -1。表驱动与递归上升代码共用，保证两者出错前的动作一致
+    static int defaultReduction(const QMap<int, int> &reduceCounts);
+
+    struct Options {
+        bool compress = true;          // 行位移压缩；否则按稠密数组存放
+        bool defaultReductions = true; // 每行最常见的归约作为默认动作，GOTO 每列取最常见目标为默认
+    };
+
+    // augG 为 LRAnalyzer::getAugmentedGrammar()，表中的编号均基于它
+    void build(const LRTable &table, const Grammar &augG, int stateCount, const Options &options);
+    void build(const LRTable &table, const Grammar &augG, int stateCount) { build(table, augG, stateCount, Options()); }
+
+    // 一次 check 读取 + 一次 value 读取（或默认值读取）
+    int action(int state, int terminal) const
+    {
+        int i = actionBase[state] + terminal;
+        return actionCheck[i] == state ? actionValue[i] : defaultAction[state];
+    }
+    // nonTerminal 为符号编号
+    int goTo(int state, int nonTerminal) const
+    {
+        int n = nonTerminal - terminalCount;
+        int i = gotoBase[state] + n;
+        return gotoCheck[i] == state ? gotoValue[i] : defaultGoto[n];
+    }
+
+    int productionLength(int prodId) const { return prodLength[prodId]; }
+    int productionLeft(int prodId) const { return prodLeft[prodId]; }
+
+    int getStateCount() const { return stateCount; }
+    int getTerminalCount() const { return terminalCount; }
+    int entryCount() const { return actionValue.size() + gotoValue.size(); } // 打包后的数组长度
+    int denseEntryCount() const { return stateCount * symbolCount; }         // 未压缩时的格子数
+
+private:
+    friend class CodeGenerator; // 导出数组
+
+    int stateCount = 0;
+    int terminalCount = 0;
+    int symbolCount = 0;
+
+    QVector<int> actionBase, actionCheck, actionValue, defaultAction;
+    QVector<int> gotoBase, gotoCheck, gotoValue, defaultGoto;
+    QVector<int> prodLength, prodLeft;
+};
+
+#endif // COMPILEDTABLE_H
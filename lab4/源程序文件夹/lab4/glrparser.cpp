@@ -0,0 +1,316 @@
+#include "glrparser.h"
+
+#include "compiledtable.h"
+#include <algorithm>
+#include <limits>
+
+void GLRTable::build(const LRAnalyzer &analyzer, Lookahead kind)
+{
+    const Grammar &g = analyzer.getAugmentedGrammar();
+    terminalCount = g.symbols.terminalCount;
+    nonTerminalCount = g.symbols.size() - terminalCount;
+    stateCount = kind == LR1 ? analyzer.getLR1States().size() : analyzer.getLR0States().size();
+    const int acceptProd = g.prodsByLeft.value(g.startSymbol).value(0, -1); // 增广产生式
+
+    prodLength.resize(g.productions.size());
+    prodLeft.resize(g.productions.size());
+    for (const Production &p : g.productions) {
+        prodLength[p.id] = p.right.size();
+        prodLeft[p.id] = p.left;
+    }
+
+    // 先按格子收集动作（去重），再压成连续数组
+    QVector<QVector<int>> cells(stateCount * terminalCount);
+    gotoTable.fill(-1, stateCount * nonTerminalCount);
+    auto addAction = [&](int state, int terminal, int action) {
+        QVector<int> &cell = cells[state * terminalCount + terminal];
+        if (!cell.contains(action)) cell.append(action);
+    };
+    auto addTransitions = [&](int state, const QMap<int, int> &transitions) {
+        for (auto it = transitions.begin(); it != transitions.end(); ++it) {
+            if (g.isTerminal(it.key())) addAction(state, it.key(), CompiledTable::encodeShift(it.value()));
+            else gotoTable[state * nonTerminalCount + it.key() - terminalCount] = it.value();
+        }
+    };
+    auto addReductions = [&](int state, int prodId, const TerminalSet &lookaheads) {
+        if (prodId == acceptProd) {
+            if (lookaheads.contains(Grammar::EndMarker)) addAction(state, Grammar::EndMarker, CompiledTable::Accept);
+            return;
+        }
+        lookaheads.forEach([&](int t) { addAction(state, t, CompiledTable::encodeReduce(prodId)); });
+    };
+
+    if (kind == LR1) {
+        for (const LR1State &s : analyzer.getLR1States()) {
+            addTransitions(s.id, s.transitions);
+            for (auto it = s.reductions.begin(); it != s.reductions.end(); ++it) addReductions(s.id, it.key(), it.value());
+        }
+    } else {
+        TerminalSet allTerminals(terminalCount);
+        for (int t = 0; t < terminalCount; ++t) allTerminals.insert(t);
+        for (const LR0State &s : analyzer.getLR0States()) {
+            addTransitions(s.id, s.transitions);
+            for (const LR0Item &item : analyzer.lr0Closure(s.id)) {
+                const Production &p = g.productions[item.prodId];
+                if (item.dotPos != p.right.size()) continue;
+                if (kind == LR0) addReductions(s.id, item.prodId, allTerminals);
+                else if (kind == SLR1) addReductions(s.id, item.prodId, item.prodId == acceptProd ? allTerminals : g.follow[p.left]);
+                else addReductions(s.id, item.prodId, item.prodId == acceptProd ? allTerminals : analyzer.lalrLookahead(s.id, item.prodId));
+            }
+        }
+    }
+
+    // 按优先级裁决移进-归约冲突，规则与 LRAnalyzer::fillReduceActions 相同：每个归约各自与移进比较，
+    // 输给移进或 %nonassoc 的归约去掉；只有所有归约都胜过移进时才去掉移进
+    for (int c = 0; c < cells.size(); ++c) {
+        QVector<int> &cell = cells[c];
+        if (cell.size() < 2) continue;
+        if (std::none_of(cell.begin(), cell.end(), [](int a) { return CompiledTable::isShift(a); })) continue;
+        const int terminal = c % terminalCount;
+        bool shiftBeaten = true;
+        cell.erase(std::remove_if(cell.begin(), cell.end(), [&](int a) {
+            if (!CompiledTable::isReduce(a)) return false;
+            switch (g.resolveShiftReduce(CompiledTable::reduceProduction(a), terminal)) {
+            case Grammar::ShiftReduce::Shift: shiftBeaten = false; return true;
+            case Grammar::ShiftReduce::Reduce: return false;
+            case Grammar::ShiftReduce::Error: return true;
+            default: shiftBeaten = false; return false;
+            }
+        }), cell.end());
+        if (shiftBeaten) {
+            cell.erase(std::remove_if(cell.begin(), cell.end(), [](int a) { return CompiledTable::isShift(a); }), cell.end());
+        }
+    }
+
+    cellStart.resize(cells.size() + 1);
+    actionList.clear();
+    conflictCells = 0;
+    for (int c = 0; c < cells.size(); ++c) {
+        cellStart[c] = actionList.size();
+        actionList.append(cells[c]);
+        if (cells[c].size() > 1) ++conflictCells;
+    }
+    cellStart[cells.size()] = actionList.size();
+}
+
+GLRParser::GLRParser(const GLRTable &table)
+    : table(table)
+{
+}
+
+int GLRParser::addNode(int state)
+{
+    const int id = gss.size();
+    gss.append(GSSNode{state, level, -1});
+    stateNode[state] = id;
+    frontier.append(id);
+    return id;
+}
+
+int GLRParser::addEdge(int from, int to, int label)
+{
+    const int id = edges.size();
+    edges.append(GSSEdge{to, label, gss[from].firstEdge});
+    gss[from].firstEdge = id;
+    return id;
+}
+
+void GLRParser::queueReductions(int node, int requiredEdge)
+{
+    const int state = gss[node].state;
+    const int *acts = table.actions(state, lookahead);
+    for (int k = table.actionCount(state, lookahead) - 1; k >= 0; --k) {
+        if (!CompiledTable::isReduce(acts[k])) continue;
+        const int prodId = CompiledTable::reduceProduction(acts[k]);
+        if (requiredEdge >= 0 && table.productionLength(prodId) == 0) continue; // 空归约不经过任何边
+        pending.append(Reduction{node, prodId, requiredEdge});
+    }
+}
+
+bool GLRParser::parse(const QVector<int> &tokens)
+{
+    gss.clear();
+    edges.clear();
+    nodes.clear();
+    packedNodes.clear();
+    frontier.clear();
+    stateNode.fill(-1, table.getStateCount());
+    rootNode = -1;
+    errorPos = -1;
+
+    level = 0;
+    addNode(0);
+    for (int pos = 0; pos < tokens.size(); ++pos) {
+        level = pos;
+        lookahead = tokens[pos];
+        levelSymbols.clear();
+
+        // 归约：直到当前位置不再产生新的节点和边
+        for (int v : frontier) queueReductions(v, -1);
+        while (!pending.isEmpty()) reduce(pending.takeLast());
+
+        if (lookahead == Grammar::EndMarker) {
+            for (int v : frontier) {
+                const int state = gss[v].state;
+                const int *acts = table.actions(state, lookahead);
+                for (int k = 0; k < table.actionCount(state, lookahead); ++k) {
+                    if (acts[k] != CompiledTable::Accept) continue;
+                    rootNode = edges[gss[v].firstEdge].label; // S' -> S· 所在节点只有一条回到起始节点的边
+                    return true;
+                }
+            }
+            errorPos = pos;
+            return false;
+        }
+
+        // 移进：所有能移进当前符号的节点共享同一个终结符森林节点
+        QVector<QPair<int, int>> shifts; // (节点, 目标状态)
+        for (int v : frontier) {
+            const int state = gss[v].state;
+            const int *acts = table.actions(state, lookahead);
+            for (int k = 0; k < table.actionCount(state, lookahead); ++k) {
+                if (CompiledTable::isShift(acts[k])) shifts.append(qMakePair(v, CompiledTable::shiftTarget(acts[k])));
+            }
+        }
+        for (int v : frontier) stateNode[gss[v].state] = -1;
+        frontier.clear();
+        if (shifts.isEmpty()) {
+            errorPos = pos;
+            return false;
+        }
+
+        const int leaf = nodes.size();
+        nodes.append(SPPFNode{lookahead, pos, pos + 1, {}});
+        level = pos + 1;
+        for (const QPair<int, int> &s : shifts) {
+            int w = stateNode[s.second];
+            if (w < 0) w = addNode(s.second);
+            addEdge(w, s.first, leaf);
+        }
+    }
+    errorPos = tokens.size() - 1; // 缺少结尾的 #
+    return false;
+}
+
+void GLRParser::reduce(const Reduction &r)
+{
+    const int len = table.productionLength(r.prodId);
+    pathLabels.resize(len);
+    if (len == 0) reduceAlong(r, r.node);
+    else reducePaths(r, r.node, 0, r.requiredEdge < 0);
+}
+
+// 从 node 出发沿出边再走 len - depth 步，走过的边的标号从右往左填入 pathLabels
+void GLRParser::reducePaths(const Reduction &r, int node, int depth, bool usedRequired)
+{
+    const int len = pathLabels.size();
+    if (depth == len) {
+        if (usedRequired) reduceAlong(r, node);
+        return;
+    }
+    for (int e = gss[node].firstEdge; e >= 0; e = edges[e].next) {
+        pathLabels[len - 1 - depth] = edges[e].label;
+        reducePaths(r, edges[e].to, depth + 1, usedRequired || e == r.requiredEdge);
+    }
+}
+
+// 归约路径到达 target：在当前位置登记 goto(target, A) 节点与回到 target 的边
+void GLRParser::reduceAlong(const Reduction &r, int target)
+{
+    const int A = table.productionLeft(r.prodId);
+    const int k = table.goTo(gss[target].state, A);
+    if (k < 0) return;
+
+    const QPair<int, int> key(A, gss[target].level);
+    int label = levelSymbols.value(key, -1);
+    if (label < 0) {
+        label = nodes.size();
+        nodes.append(SPPFNode{A, gss[target].level, level, {}});
+        levelSymbols.insert(key, label);
+    }
+    addPacked(label, r.prodId, pathLabels);
+
+    int w = stateNode[k];
+    if (w < 0) {
+        w = addNode(k);
+        addEdge(w, target, label);
+        queueReductions(w, -1);
+        return;
+    }
+    // 状态的入口符号唯一，已有的同向边标号必然就是 label，新推导已经并入它的打包节点
+    for (int e = gss[w].firstEdge; e >= 0; e = edges[e].next) {
+        if (edges[e].to == target) return;
+    }
+    // 已有节点多了一条边：经过这条边的归约路径此前都没有走过（Farshi），对当前位置的节点重新归约
+    const int e = addEdge(w, target, label);
+    for (int x : frontier) queueReductions(x, e);
+}
+
+void GLRParser::addPacked(int node, int prodId, const QVector<int> &children)
+{
+    for (int p : nodes[node].packed) {
+        if (packedNodes[p].prodId == prodId && packedNodes[p].children == children) return;
+    }
+    nodes[node].packed.append(packedNodes.size());
+    packedNodes.append(PackedNode{prodId, children});
+}
+
+qint64 GLRParser::treeCount(int node) const
+{
+    QVector<qint64> memo(nodes.size(), -2); // -2 未计算
+    QVector<bool> onPath(nodes.size(), false);
+    return countTrees(node, memo, onPath);
+}
+
+qint64 GLRParser::countTrees(int node, QVector<qint64> &memo, QVector<bool> &onPath) const
+{
+    const qint64 maxCount = std::numeric_limits<qint64>::max();
+    if (memo[node] != -2) return memo[node];
+    if (nodes[node].packed.isEmpty()) return memo[node] = 1;
+    if (onPath[node]) return -1;
+
+    onPath[node] = true;
+    qint64 total = 0;
+    for (int p : nodes[node].packed) {
+        qint64 product = 1;
+        for (int child : packedNodes[p].children) {
+            const qint64 n = countTrees(child, memo, onPath);
+            if (n < 0) {
+                onPath[node] = false;
+                return memo[node] = -1;
+            }
+            product = n != 0 && product > maxCount / n ? maxCount : product * n;
+        }
+        total = total > maxCount - product ? maxCount : total + product;
+    }
+    onPath[node] = false;
+    return memo[node] = total;
+}
+
+QString GLRParser::firstTreeToString(const Grammar &g, int node) const
+{
+    QString out;
+    QVector<bool> onPath(nodes.size(), false);
+    writeTree(g, node, onPath, out);
+    return out;
+}
+
+void GLRParser::writeTree(const Grammar &g, int node, QVector<bool> &onPath, QString &out) const
+{
+    const SPPFNode &n = nodes[node];
+    out += g.symbolName(n.symbol);
+    if (n.packed.isEmpty()) return;
+    if (onPath[node]) {
+        out += "(...)";
+        return;
+    }
+    onPath[node] = true;
+    out += '(';
+    const QVector<int> &children = packedNodes[n.packed[0]].children;
+    for (int i = 0; i < children.size(); ++i) {
+        if (i > 0) out += ' ';
+        writeTree(g, children[i], onPath, out);
+    }
+    out += ')';
+    onPath[node] = false;
+}
@@ -0,0 +1,136 @@
+#ifndef GLRPARSER_H
+#define GLRPARSER_H
+
+#include "grammar.h"
+#include "lr.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// GLR 分析用的 ACTION/GOTO。与 LRTable 不同，冲突的格子保留全部动作（能按优先级声明裁决的
+// 移进-归约冲突先裁决，与 LRAnalyzer 填表一致）；
+// 动作的编码与 CompiledTable 相同（移进为正、归约为负、Accept 为 INT_MIN）。
+class GLRTable
+{
+public:
+    // 归约动作的向前看来源：前三种基于 LR(0) 自动机，LR1 基于 LR(1) 状态（规范或最小 LR(1) 均可）
+    enum Lookahead { LR0, SLR1, LALR1, LR1 };
+
+    // analyzer 须已构造相应的自动机：LR0/SLR1 需 buildLR0()，LALR1 还需 buildLALRTable()，
+    // LR1 需 buildLR1() 或 buildMinimalLR1()
+    void build(const LRAnalyzer &analyzer, Lookahead kind);
+
+    int actionCount(int state, int terminal) const
+    {
+        const int cell = state * terminalCount + terminal;
+        return cellStart[cell + 1] - cellStart[cell];
+    }
+    const int *actions(int state, int terminal) const { return actionList.constData() + cellStart[state * terminalCount + terminal]; }
+    int goTo(int state, int nonTerminal) const { return gotoTable[state * nonTerminalCount + nonTerminal - terminalCount]; } // 无转移为 -1
+
+    int productionLength(int prodId) const { return prodLength[prodId]; }
+    int productionLeft(int prodId) const { return prodLeft[prodId]; }
+
+    int getStateCount() const { return stateCount; }
+    int getTerminalCount() const { return terminalCount; }
+    int conflictCellCount() const { return conflictCells; } // 含多个动作的格子数
+
+private:
+    int stateCount = 0;
+    int terminalCount = 0;
+    int nonTerminalCount = 0;
+    int conflictCells = 0;
+    QVector<int> cellStart;  // (状态, 终结符) -> actionList 中的起始位置，末尾多一项
+    QVector<int> actionList;
+    QVector<int> gotoTable;  // 稠密的 状态 × 非终结符
+    QVector<int> prodLength, prodLeft;
+};
+
+// 共享打包分析森林（SPPF）中的节点：符号 symbol 覆盖输入 [start, end) 的全部推导。
+// 每种推导是一个打包节点；终结符节点没有打包节点
+struct SPPFNode {
+    int symbol;
+    int start;
+    int end;
+    QVector<int> packed;
+};
+
+struct PackedNode {
+    int prodId;
+    QVector<int> children; // SPPF 节点，与产生式右部一一对应
+};
+
+// GLR 分析驱动（Tomita 算法，按 Farshi 的方法处理空产生式）。
+// 分析栈为图结构栈（GSS）：同一输入位置上同一状态只有一个节点，冲突时栈分叉、归约到同一状态时合并；
+// 没有冲突的部分与普通 LR 分析一样每步只处理一个节点，因此常见文法上接近线性时间。
+// 同一 (符号, 区间) 的所有推导共享一个森林节点，歧义只体现为该节点下的多个打包节点，不会按分析树数目展开。
+class GLRParser
+{
+public:
+    explicit GLRParser(const GLRTable &table);
+
+    // tokens 为终结符编号序列，须以 Grammar::EndMarker 结尾
+    bool parse(const QVector<int> &tokens);
+
+    int errorPosition() const { return errorPos; } // 出错时的输入位置，接受时为 -1
+
+    // 分析森林，接受后有效；root 为开始符号覆盖整个句子的节点（不含增广产生式）
+    const QVector<SPPFNode>& forestNodes() const { return nodes; }
+    const QVector<PackedNode>& forestPackedNodes() const { return packedNodes; }
+    int root() const { return rootNode; }
+
+    // 节点下的分析树数目；超过 qint64 时取最大值，文法有环（A =>+ A）导致无穷多时返回 -1
+    qint64 treeCount(int node) const;
+    // 每个节点取第一种推导，写成 A(B(b) c) 形式；有环时环上的节点写作 A(...)
+    QString firstTreeToString(const Grammar &g, int node) const;
+
+    int gssNodeCount() const { return gss.size(); }
+    int gssEdgeCount() const { return edges.size(); }
+
+private:
+    struct GSSNode {
+        int state;
+        int level;
+        int firstEdge; // 出边链表
+    };
+    struct GSSEdge {
+        int to;
+        int label; // SPPF 节点
+        int next;
+    };
+    struct Reduction {
+        int node;
+        int prodId;
+        int requiredEdge; // 归约路径必须经过的边，-1 表示不限
+    };
+
+    const GLRTable &table;
+    QVector<GSSNode> gss;
+    QVector<GSSEdge> edges;
+    QVector<SPPFNode> nodes;
+    QVector<PackedNode> packedNodes;
+    int rootNode = -1;
+    int errorPos = -1;
+
+    // 当前输入位置上的节点；stateNode 按状态索引，处理完一个位置后只清理用过的项
+    QVector<int> frontier;
+    QVector<int> stateNode;
+    QHash<QPair<int, int>, int> levelSymbols; // 当前位置结束的 (非终结符, 起点) -> SPPF 节点
+    QVector<Reduction> pending;
+    QVector<int> pathLabels;
+
+    int level = 0;
+    int lookahead = 0;
+
+    int addNode(int state);
+    int addEdge(int from, int to, int label);
+    void queueReductions(int node, int requiredEdge);
+    void reduce(const Reduction &r);
+    void reducePaths(const Reduction &r, int node, int depth, bool usedRequired);
+    void reduceAlong(const Reduction &r, int target);
+    void addPacked(int node, int prodId, const QVector<int> &children);
+    qint64 countTrees(int node, QVector<qint64> &memo, QVector<bool> &onPath) const;
+    void writeTree(const Grammar &g, int node, QVector<bool> &onPath, QString &out) const;
+};
+
+#endif // GLRPARSER_H
@@ -2,23 +2,130 @@
 
 #include <QStringList>
 #include <QObject>
+#include <QRegularExpression>
+#include <algorithm>
+
+void SymbolTable::clear()
+{
+    names.clear();
+    ids.clear();
+    terminalCount = 0;
+}
+
+int SymbolTable::addTerminal(const QString &name)
+{
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd()) return it.value();
+    int id = names.size();
+    names.append(name);
+    ids.insert(name, id);
+    terminalCount = names.size();
+    return id;
+}
+
+int SymbolTable::addNonTerminal(const QString &name)
+{
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd()) return it.value();
+    int id = names.size();
+    names.append(name);
+    ids.insert(name, id);
+    return id;
+}
+
+int Grammar::addNonTerminal(const QString &name)
+{
+    int id = symbols.addNonTerminal(name);
+    if (prodsByLeft.size() < symbols.size()) prodsByLeft.resize(symbols.size());
+    return id;
+}
+
+QString Grammar::productionToString(int prodId) const
+{
+    const Production &p = productions[prodId];
+    QStringList rhs;
+    for (int sym : p.right) rhs << symbols.name(sym);
+    return QString("%1 -> %2").arg(symbols.name(p.left), rhs.isEmpty() ? epsilon : rhs.join(" "));
+}
+
+QStringList Grammar::splitSymbols(const QString &text)
+{
+    // 自定义分词：字母/数字连续串为一个符号，其它单字符
+    QStringList result;
+    QString token;
+    auto flushToken = [&]() {
+        if (!token.isEmpty()) {
+            result.append(token);
+            token.clear();
+        }
+    };
+    for (QChar ch : text) {
+        if (ch.isSpace()) {
+            flushToken();
+        } else if (ch.isLetterOrNumber() || ch == '_') {
+            token.append(ch);
+        } else {
+            flushToken();
+            // 括号、运算符等单独成符号，例如 '(', ')', '+', '*', '/' 等
+            result.append(QString(ch));
+        }
+    }
+    flushToken();
+    return result;
+}
 
 bool Grammar::parseFromText(const QString &text, QString &errorMsg)
 {
     productions.clear();
-    nonTerminals.clear();
-    terminals.clear();
+    symbols.clear();
     prodsByLeft.clear();
     first.clear();
     follow.clear();
-    startSymbol.clear();
+    nullable.clear();
+    terminalPrecedence.clear();
+    startSymbol = -1;
+
+    // 第一遍：切分产生式。终结符要等所有左部都出现后才能确定，所以先按名字保存
+    struct RawProduction {
+        QString left;
+        QStringList right;
+        QString prec; // %prec 指定的符号
+    };
+    QVector<RawProduction> raw;
+    QStringList leftOrder;
+    QSet<QString> leftNames;
+    QHash<QString, Precedence> declared; // 优先级声明，按名字
+    int level = 0;
+
+    static const QRegularExpression declaration("^%(left|right|nonassoc)(\\s.*)?$");
+    static const QRegularExpression precClause("\\s*%prec\\s+(\\S+)$");
 
     QStringList lines = text.split('\n');
-    int idCounter = 0;
     for (const QString &rawLine : lines) {
         QString line = rawLine.trimmed();
         if (line.isEmpty()) continue;
 
+        QRegularExpressionMatch decl = declaration.match(line);
+        if (decl.hasMatch()) {
+            Precedence prec;
+            prec.level = ++level;
+            const QString kind = decl.captured(1);
+            prec.assoc = kind == "left" ? Precedence::Left : kind == "right" ? Precedence::Right : Precedence::NonAssoc;
+            const QStringList names = splitSymbols(decl.captured(2));
+            if (names.isEmpty()) {
+                errorMsg = QObject::tr("优先级声明中没有符号: %1").arg(line);
+                return false;
+            }
+            for (const QString &name : names) {
+                if (declared.contains(name)) {
+                    errorMsg = QObject::tr("符号 %1 的优先级重复声明").arg(name);
+                    return false;
+                }
+                declared.insert(name, prec);
+            }
+            continue;
+        }
+
         QStringList parts = line.split("->");
         if (parts.size() != 2) {
             errorMsg = QObject::tr("文法行格式错误: %1").arg(line);
@@ -29,194 +136,583 @@ bool Grammar::parseFromText(const QString &text, QString &errorMsg)
             errorMsg = QObject::tr("左部为空: %1").arg(line);
             return false;
         }
-        if (startSymbol.isEmpty()) startSymbol = left;
-        nonTerminals.insert(left);
+        if (!leftNames.contains(left)) {
+            leftNames.insert(left);
+            leftOrder << left;
+        }
 
         QString rightPart = parts[1];
         QStringList alts = rightPart.split('|');
         for (QString alt : alts) {
             alt = alt.trimmed();
-            QList<QString> symbols;
-            if (alt == epsilon) {
-                // epsilon 产生式，right 为空列表表示 @
-            } else {
-                // 自定义分词：字母/数字连续串为一个符号，其它单字符
-                QString token;
-                auto flushToken = [&]() {
-                    if (!token.isEmpty()) {
-                        symbols.append(token);
-                        token.clear();
-                    }
-                };
-                for (QChar ch : alt) {
-                    if (ch.isSpace()) {
-                        flushToken();
-                    } else if (ch.isLetterOrNumber() || ch == '_') {
-                        token.append(ch);
-                    } else {
-                        flushToken();
-                        // 括号、运算符等单独成符号，例如 '(', ')', '+', '*', '/' 等
-                        symbols.append(QString(ch));
-                    }
-                }
-                flushToken();
+            QString prec;
+            QRegularExpressionMatch m = precClause.match(alt);
+            if (m.hasMatch()) {
+                prec = m.captured(1);
+                alt = alt.left(m.capturedStart()).trimmed();
             }
-            Production p;
-            p.id = idCounter++;
-            p.left = left;
-            p.right = symbols;
-            productions.append(p);
-            prodsByLeft[left].append(p.id);
+            // epsilon 产生式，right 为空列表表示 @
+            QStringList rhsSymbols;
+            if (alt != epsilon) rhsSymbols = splitSymbols(alt);
+            rhsSymbols.removeAll(epsilon);
+            raw.append(RawProduction{left, rhsSymbols, prec});
         }
     }
 
-    // 统计终结符：出现在右部但不在 nonTerminals 中且不是 epsilon
-    for (const Production &p : productions) {
-        for (const QString &sym : p.right) {
-            if (sym == epsilon) continue;
-            if (!nonTerminals.contains(sym)) {
-                terminals.insert(sym);
+    for (auto it = declared.constBegin(); it != declared.constEnd(); ++it) {
+        if (leftNames.contains(it.key())) {
+            errorMsg = QObject::tr("不能为非终结符 %1 声明优先级").arg(it.key());
+            return false;
+        }
+    }
+
+    // 第二遍：分配编号。# 固定为 0 号，其余终结符按出现顺序，然后是非终结符
+    symbols.addTerminal(endMarker);
+    for (const RawProduction &rp : raw) {
+        for (const QString &sym : rp.right) {
+            if (!leftNames.contains(sym)) symbols.addTerminal(sym);
+        }
+    }
+    for (const QString &nt : leftOrder) {
+        symbols.addNonTerminal(nt);
+    }
+    prodsByLeft.resize(symbols.size());
+    if (!leftOrder.isEmpty()) startSymbol = symbols.id(leftOrder.first());
+
+    // 只出现在声明或 %prec 中的名字不是文法符号，不占编号
+    terminalPrecedence.resize(symbols.terminalCount);
+    for (int t = 0; t < symbols.terminalCount; ++t) terminalPrecedence[t] = declared.value(symbols.name(t));
+
+    for (const RawProduction &rp : raw) {
+        Production p;
+        p.id = productions.size();
+        p.left = symbols.id(rp.left);
+        p.right.reserve(rp.right.size());
+        for (const QString &sym : rp.right) p.right.append(symbols.id(sym));
+        // 与 yacc 相同：没有 %prec 时取右部最后一个终结符的优先级
+        if (!rp.prec.isEmpty()) {
+            if (!declared.contains(rp.prec)) {
+                errorMsg = QObject::tr("%prec 使用了未声明优先级的符号 %1").arg(rp.prec);
+                return false;
+            }
+            p.precedence = declared.value(rp.prec).level;
+        } else {
+            for (int i = p.right.size() - 1; i >= 0; --i) {
+                if (isTerminal(p.right[i])) {
+                    p.precedence = terminalPrecedence[p.right[i]].level;
+                    break;
+                }
             }
         }
+        productions.append(p);
+        prodsByLeft[p.left].append(p.id);
     }
 
     return true;
 }
 
-void Grammar::computeFirst()
+Grammar::ShiftReduce Grammar::resolveShiftReduce(int prodId, int terminal) const
 {
-    first.clear();
-    // 初始化非终结符 FIRST 集为空
-    for (const QString &nt : nonTerminals) {
-        first[nt] = QSet<QString>();
+    const int rule = productions[prodId].precedence;
+    const Precedence token = terminalPrecedence.value(terminal);
+    if (rule == 0 || token.level == 0) return ShiftReduce::Unresolved;
+    if (rule != token.level) return rule > token.level ? ShiftReduce::Reduce : ShiftReduce::Shift;
+    switch (token.assoc) {
+    case Precedence::Left: return ShiftReduce::Reduce;
+    case Precedence::Right: return ShiftReduce::Shift;
+    default: return ShiftReduce::Error;
     }
-    // 终结符的 FIRST 是其自身
-    for (const QString &t : terminals) {
-        first[t] = QSet<QString>({t});
-    }
-    first[epsilon] = QSet<QString>({epsilon});
-
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (const Production &p : productions) {
-            QSet<QString> &firstA = first[p.left];
-            if (p.right.isEmpty()) {
-                if (!firstA.contains(epsilon)) {
-                    firstA.insert(epsilon);
-                    changed = true;
+}
+
+QString GrammarReduction::toString() const
+{
+    QStringList lines;
+    if (!unproductive.isEmpty()) lines << QObject::tr("非产生的非终结符：%1").arg(unproductive.join(" "));
+    if (!unreachable.isEmpty()) lines << QObject::tr("不可达的符号：%1").arg(unreachable.join(" "));
+    if (!productions.isEmpty()) {
+        lines << QObject::tr("删去的产生式：");
+        for (const QString &p : productions) lines << "  " + p;
+    }
+    return lines.join("\n");
+}
+
+GrammarReduction Grammar::removeUselessSymbols()
+{
+    GrammarReduction report;
+    if (startSymbol < 0) return report;
+    const int n = symbols.size();
+    const int T = symbols.terminalCount;
+
+    // 产生的：终结符都是；产生式右部的非终结符全部已知产生时，左部也是。
+    // pending[p] 为产生式 p 右部尚未确认的非终结符出现次数，occurrences[A] 列出 A 出现在哪些产生式右部
+    QVector<bool> productive(n, false);
+    QVector<int> pending(productions.size(), 0);
+    QVector<QVector<int>> occurrences(n);
+    QVector<int> worklist;
+    for (const Production &p : productions) {
+        for (int sym : p.right) {
+            if (sym >= T) {
+                ++pending[p.id];
+                occurrences[sym].append(p.id);
+            }
+        }
+        if (pending[p.id] == 0 && !productive[p.left]) {
+            productive[p.left] = true;
+            worklist.append(p.left);
+        }
+    }
+    while (!worklist.isEmpty()) {
+        const int A = worklist.takeLast();
+        for (int prodId : occurrences[A]) {
+            const int B = productions[prodId].left;
+            if (--pending[prodId] == 0 && !productive[B]) {
+                productive[B] = true;
+                worklist.append(B);
+            }
+        }
+    }
+    for (int sym = 0; sym < T; ++sym) productive[sym] = true;
+
+    auto usable = [&](const Production &p) {
+        if (!productive[p.left]) return false;
+        for (int sym : p.right) {
+            if (!productive[sym]) return false;
+        }
+        return true;
+    };
+
+    // 可达的：只沿留下的产生式从开始符号出发。# 总是保留
+    QVector<bool> reachable(n, false);
+    reachable[EndMarker] = true;
+    reachable[startSymbol] = true;
+    worklist.append(startSymbol);
+    while (!worklist.isEmpty()) {
+        const int A = worklist.takeLast();
+        for (int prodId : prodsByLeft[A]) {
+            const Production &p = productions[prodId];
+            if (!usable(p)) continue;
+            for (int sym : p.right) {
+                if (reachable[sym]) continue;
+                reachable[sym] = true;
+                if (sym >= T) worklist.append(sym);
+            }
+        }
+    }
+
+    QVector<int> newId(n, -1);
+    for (int sym = 0; sym < n; ++sym) {
+        if (!productive[sym]) report.unproductive << symbols.name(sym); // 含开始符号时语言为空
+        else if (!reachable[sym]) report.unreachable << symbols.name(sym);
+    }
+    QVector<Production> kept;
+    for (const Production &p : productions) {
+        if (usable(p) && reachable[p.left]) kept.append(p);
+        else report.productions << productionToString(p.id);
+    }
+    if (report.isEmpty()) return report;
+
+    // 按原顺序重建符号表与产生式
+    SymbolTable old = symbols;
+    const QVector<Precedence> oldPrecedence = terminalPrecedence;
+    symbols.clear();
+    terminalPrecedence.clear();
+    for (int sym = 0; sym < old.terminalCount; ++sym) {
+        if (!reachable[sym]) continue;
+        newId[sym] = symbols.addTerminal(old.name(sym));
+        terminalPrecedence.append(oldPrecedence.value(sym));
+    }
+    for (int sym = old.terminalCount; sym < n; ++sym) {
+        if (sym == startSymbol || (productive[sym] && reachable[sym])) newId[sym] = symbols.addNonTerminal(old.name(sym));
+    }
+    startSymbol = newId[startSymbol];
+
+    productions.clear();
+    prodsByLeft = QVector<QVector<int>>(symbols.size());
+    for (Production p : kept) {
+        p.id = productions.size();
+        p.left = newId[p.left];
+        for (int &sym : p.right) sym = newId[sym];
+        productions.append(p);
+        prodsByLeft[p.left].append(p.id);
+    }
+
+    first.clear();
+    follow.clear();
+    nullable.clear();
+    suffixOffset.clear();
+    suffixFirsts.clear();
+    suffixNullables.clear();
+    return report;
+}
+
+// 用迭代版 Tarjan 算法求强连通分量；Tarjan 输出分量的顺序恰好是依赖在前，
+// 同一分量内的结点互相包含、结果相同，所以每个分量只需合并一遍即可定值。
+void solveSetEquations(const QVector<QVector<int>> &deps, QVector<TerminalSet> &sets)
+{
+    const int n = deps.size();
+    QVector<int> index(n, -1), low(n, 0), component(n, -1);
+    QVector<bool> onStack(n, false);
+    QVector<int> stack;
+    QVector<QPair<int, int>> callStack; // (结点, 下一条待访问的边)
+    int counter = 0;
+    int componentCount = 0;
+
+    for (int root = 0; root < n; ++root) {
+        if (index[root] != -1) continue;
+        callStack.append(qMakePair(root, 0));
+        while (!callStack.isEmpty()) {
+            int v = callStack.last().first;
+            int &edge = callStack.last().second;
+            if (edge == 0 && index[v] == -1) {
+                index[v] = low[v] = counter++;
+                stack.append(v);
+                onStack[v] = true;
+            }
+            if (edge < deps[v].size()) {
+                int w = deps[v][edge++];
+                if (index[w] == -1) {
+                    callStack.append(qMakePair(w, 0));
+                } else if (onStack[w]) {
+                    low[v] = qMin(low[v], index[w]);
                 }
                 continue;
             }
-            bool allNullable = true;
-            for (const QString &X : p.right) {
-                QSet<QString> &firstX = first[X];
-                for (const QString &a : firstX) {
-                    if (a == epsilon) continue;
-                    if (!firstA.contains(a)) {
-                        firstA.insert(a);
-                        changed = true;
-                    }
-                }
-                if (!firstX.contains(epsilon)) {
-                    allNullable = false;
-                    break;
-                }
+
+            // v 的所有边都已访问
+            callStack.removeLast();
+            if (!callStack.isEmpty()) {
+                int parent = callStack.last().first;
+                low[parent] = qMin(low[parent], low[v]);
             }
-            if (allNullable) {
-                if (!firstA.contains(epsilon)) {
-                    firstA.insert(epsilon);
-                    changed = true;
+            if (low[v] != index[v]) continue;
+
+            // v 是分量的根：弹出整个分量，先合并再统一赋值
+            QVector<int> members;
+            int w;
+            do {
+                w = stack.takeLast();
+                onStack[w] = false;
+                component[w] = componentCount;
+                members.append(w);
+            } while (w != v);
+
+            TerminalSet merged;
+            for (int m : members) {
+                merged.unite(sets[m]);
+                for (int d : deps[m]) {
+                    if (component[d] != componentCount) merged.unite(sets[d]); // 已定值的分量
                 }
             }
+            for (int m : members) sets[m] = merged;
+            ++componentCount;
         }
     }
 }
 
-void Grammar::computeFollow()
+void Grammar::computeNullable()
 {
-    follow.clear();
-    for (const QString &nt : nonTerminals) {
-        follow[nt] = QSet<QString>();
+    const int n = symbols.size();
+    nullable = QVector<bool>(n, false);
+
+    // 工作表：remaining[p] 为产生式 p 右部尚未确认可空的符号数，
+    // 某符号变为可空时只需更新出现了它的产生式
+    QVector<int> remaining(productions.size());
+    QVector<QVector<int>> occurrences(n);
+    QVector<int> work;
+    for (const Production &p : productions) {
+        remaining[p.id] = p.right.size();
+        for (int X : p.right) occurrences[X].append(p.id);
+        if (p.right.isEmpty() && !nullable[p.left]) {
+            nullable[p.left] = true;
+            work.append(p.left);
+        }
     }
-    // 开始符号加入结束符
-    if (!startSymbol.isEmpty()) {
-        follow[startSymbol].insert(endMarker);
-    }
-
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (const Production &p : productions) {
-            for (int i = 0; i < p.right.size(); ++i) {
-                QString B = p.right[i];
-                if (!nonTerminals.contains(B)) continue;
-
-                // 计算 FIRST(beta)
-                QList<QString> beta;
-                for (int j = i + 1; j < p.right.size(); ++j) {
-                    beta.append(p.right[j]);
+    while (!work.isEmpty()) {
+        int X = work.takeLast();
+        for (int pid : occurrences[X]) {
+            if (--remaining[pid] == 0) {
+                int A = productions[pid].left;
+                if (!nullable[A]) {
+                    nullable[A] = true;
+                    work.append(A);
                 }
+            }
+        }
+    }
+}
 
-                bool betaNullable = false;
-                QSet<QString> firstBeta = firstOfSequence(beta, betaNullable);
+void Grammar::computeFirst()
+{
+    computeNullable();
 
-                // 将 FIRST(beta)\{@} 加入 FOLLOW(B)
-                for (const QString &a : firstBeta) {
-                    if (a == epsilon) continue;
-                    if (!follow[B].contains(a)) {
-                        follow[B].insert(a);
-                        changed = true;
-                    }
-                }
+    const int n = symbols.size();
+    const int T = symbols.terminalCount;
+    first = QVector<TerminalSet>(n, TerminalSet(T));
+    // 终结符的 FIRST 是其自身
+    for (int t = 0; t < T; ++t) {
+        first[t].insert(t);
+    }
 
-                // 如果 beta 可推导空，将 FOLLOW(A) 加入 FOLLOW(B)
-                if (betaNullable || beta.isEmpty()) {
-                    for (const QString &b : follow[p.left]) {
-                        if (!follow[B].contains(b)) {
-                            follow[B].insert(b);
-                            changed = true;
-                        }
-                    }
-                }
+    // 非终结符按 (id - T) 编号：A -> X1..Xk 中，直到第一个不可空符号为止，
+    // 终结符直接加入 FIRST(A)，非终结符 Xi 形成依赖 FIRST(A) ⊇ FIRST(Xi)
+    const int N = symbols.nonTerminalCount();
+    QVector<QVector<int>> deps(N);
+    QVector<TerminalSet> sets(N, TerminalSet(T));
+    for (const Production &p : productions) {
+        int A = p.left - T;
+        for (int X : p.right) {
+            if (isTerminal(X)) {
+                sets[A].insert(X);
+                break;
             }
+            deps[A].append(X - T);
+            if (!nullable[X]) break;
         }
     }
+
+    solveSetEquations(deps, sets);
+    for (int A = 0; A < N; ++A) {
+        first[A + T] = sets[A];
+    }
+    computeSuffixFirst();
 }
 
-QSet<QString> Grammar::firstOfSequence(const QList<QString> &seq, bool &canDeriveEpsilon) const
+void Grammar::computeFollow()
 {
-    QSet<QString> result;
-    canDeriveEpsilon = true;
-    if (seq.isEmpty()) {
-        result.insert(epsilon);
-        return result;
+    const int T = symbols.terminalCount;
+    const int N = symbols.nonTerminalCount();
+    follow = QVector<TerminalSet>(symbols.size(), TerminalSet(T));
+
+    // 对 A -> α B β：FOLLOW(B) ⊇ FIRST(β)；若 β 可空，再加依赖 FOLLOW(B) ⊇ FOLLOW(A)。
+    // FIRST(β) 与 β 是否可空都从后缀表中查得
+    QVector<QVector<int>> deps(N);
+    QVector<TerminalSet> sets(N, TerminalSet(T));
+    // 开始符号加入结束符
+    if (startSymbol >= 0) {
+        sets[startSymbol - T].insert(EndMarker);
     }
 
-    for (const QString &X : seq) {
-        auto it = first.find(X);
-        QSet<QString> setX;
-        if (it != first.end()) {
-            setX = it.value();
-        } else {
-            // 若是终结符但未记录，FIRST(X)=X
-            setX.insert(X);
+    for (const Production &p : productions) {
+        for (int i = 0; i < p.right.size(); ++i) {
+            int X = p.right[i];
+            if (!isNonTerminal(X)) continue;
+            sets[X - T].unite(suffixFirst(p.id, i + 1));
+            if (suffixNullable(p.id, i + 1) && X != p.left) deps[X - T].append(p.left - T);
         }
+    }
 
-        bool nullableX = false;
-        for (const QString &a : setX) {
-            if (a == epsilon) {
-                nullableX = true;
+    solveSetEquations(deps, sets);
+    for (int A = 0; A < N; ++A) {
+        follow[A + T] = sets[A];
+    }
+}
+
+void Grammar::computeSuffixFirst()
+{
+    const int T = symbols.terminalCount;
+    suffixOffset.resize(productions.size());
+    int total = 0;
+    for (const Production &p : productions) {
+        suffixOffset[p.id] = total;
+        total += p.right.size() + 1;
+    }
+    suffixFirsts = QVector<TerminalSet>(total, TerminalSet(T));
+    suffixNullables = QVector<bool>(total, true);
+
+    // 从右往左：FIRST(X β) = FIRST(X)，X 可空时再并上 FIRST(β)
+    for (const Production &p : productions) {
+        const int base = suffixOffset[p.id];
+        for (int i = p.right.size() - 1; i >= 0; --i) {
+            const int X = p.right[i];
+            suffixFirsts[base + i] = first[X];
+            if (nullable[X]) {
+                suffixFirsts[base + i].unite(suffixFirsts[base + i + 1]);
+                suffixNullables[base + i] = suffixNullables[base + i + 1];
             } else {
-                result.insert(a);
+                suffixNullables[base + i] = false;
+            }
+        }
+    }
+}
+
+// 只求解 affected 中的变量；依赖未受影响变量 w 的边直接并入其已知值 known[w]。
+// 未受影响的变量结果取 known
+static void solveAffectedEquations(const QVector<QVector<int>> &deps, QVector<TerminalSet> &sets,
+                                   const QVector<bool> &affected, const QVector<TerminalSet> &known)
+{
+    QVector<int> local(deps.size(), -1);
+    QVector<int> vars;
+    for (int v = 0; v < deps.size(); ++v) {
+        if (affected[v]) {
+            local[v] = vars.size();
+            vars.append(v);
+        }
+    }
+    QVector<QVector<int>> localDeps(vars.size());
+    QVector<TerminalSet> localSets(vars.size());
+    for (int i = 0; i < vars.size(); ++i) {
+        localSets[i] = sets[vars[i]];
+        for (int w : deps[vars[i]]) {
+            if (local[w] >= 0) localDeps[i].append(local[w]);
+            else localSets[i].unite(known[w]);
+        }
+    }
+    solveSetEquations(localDeps, localSets);
+
+    for (int v = 0; v < deps.size(); ++v) {
+        sets[v] = affected[v] ? localSets[local[v]] : known[v];
+    }
+}
+
+// 从 affected 中已标记的变量出发，沿 users（v -> 依赖 v 的变量）标记所有可能受影响的变量
+static void propagateAffected(const QVector<QVector<int>> &users, QVector<bool> &affected)
+{
+    QVector<int> work;
+    for (int v = 0; v < affected.size(); ++v) {
+        if (affected[v]) work.append(v);
+    }
+    while (!work.isEmpty()) {
+        int v = work.takeLast();
+        for (int u : users[v]) {
+            if (!affected[u]) {
+                affected[u] = true;
+                work.append(u);
             }
         }
-        if (!nullableX) {
-            canDeriveEpsilon = false;
-            break;
+    }
+}
+
+bool Grammar::updateFirstFollow(const Grammar &previous)
+{
+    const int T = symbols.terminalCount;
+    const int N = symbols.nonTerminalCount();
+    if (startSymbol < 0 || previous.startSymbol < 0 || previous.follow.size() != previous.symbols.size()
+        || previous.symbolName(previous.startSymbol) != symbolName(startSymbol)) {
+        computeFirst();
+        computeFollow();
+        return false;
+    }
+
+    // 按名字对应新旧编号；种类（终结符/非终结符）改变的名字当作删去后新增
+    QVector<int> oldId(symbols.size(), -1);
+    QVector<int> newId(previous.symbols.size(), -1);
+    for (int s = 0; s < symbols.size(); ++s) {
+        const int o = previous.symbols.id(symbols.name(s));
+        if (o >= 0 && isTerminal(s) == previous.isTerminal(o)) {
+            oldId[s] = o;
+            newId[o] = s;
         }
     }
+    bool sameTerminals = previous.symbols.terminalCount == T;
+    for (int t = 0; t < T && sameTerminals; ++t) sameTerminals = oldId[t] == t;
+    auto remap = [&](const TerminalSet &set) {
+        if (sameTerminals) return set;
+        TerminalSet mapped(T);
+        set.forEach([&](int t) {
+            if (newId[t] >= 0) mapped.insert(newId[t]);
+        });
+        return mapped;
+    };
+    auto oldRight = [&](int pid) { // 旧产生式右部换成新编号，已删去的符号为 -1
+        QVector<int> right;
+        for (int X : previous.productions[pid].right) right.append(newId[X]);
+        return right;
+    };
 
-    if (canDeriveEpsilon) result.insert(epsilon);
-    return result;
+    // 旧结果换算到新编号；新增的非终结符没有旧结果（known 为 false），总是重新求解
+    QVector<bool> known(N, false), oldNullable(N, false);
+    QVector<TerminalSet> oldFirst(N, TerminalSet(T)), oldFollow(N, TerminalSet(T));
+    for (int A = 0; A < N; ++A) {
+        const int o = oldId[A + T];
+        if (o < 0) continue;
+        known[A] = true;
+        oldNullable[A] = previous.nullable[o];
+        oldFirst[A] = remap(previous.first[o]);
+        oldFollow[A] = remap(previous.follow[o]);
+    }
+
+    // 右部集合发生变化的非终结符（与产生式的书写顺序无关）
+    QVector<bool> prodsChanged(N, true);
+    for (int A = 0; A < N; ++A) {
+        if (!known[A]) continue;
+        QVector<QVector<int>> before, after;
+        for (int pid : previous.prodsByLeft[oldId[A + T]]) before.append(oldRight(pid));
+        for (int pid : prodsByLeft[A + T]) after.append(productions[pid].right);
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        prodsChanged[A] = before != after;
+    }
+
+    computeNullable();
+
+    // FIRST(A) 依赖 A 的右部和右部可空前缀中的符号：从右部或可空性变化的非终结符出发，
+    // 沿反向依赖找出受影响的非终结符，只对它们求解
+    QVector<QVector<int>> deps(N), users(N);
+    QVector<TerminalSet> sets(N, TerminalSet(T));
+    for (const Production &p : productions) {
+        int A = p.left - T;
+        for (int X : p.right) {
+            if (isTerminal(X)) {
+                sets[A].insert(X);
+                break;
+            }
+            deps[A].append(X - T);
+            users[X - T].append(A);
+            if (!nullable[X]) break;
+        }
+    }
+    QVector<bool> affected(N, false);
+    for (int A = 0; A < N; ++A) {
+        affected[A] = prodsChanged[A] || nullable[A + T] != oldNullable[A];
+    }
+    propagateAffected(users, affected);
+    solveAffectedEquations(deps, sets, affected, oldFirst);
+
+    first = QVector<TerminalSet>(symbols.size(), TerminalSet(T));
+    for (int t = 0; t < T; ++t) first[t].insert(t);
+    QVector<bool> firstChanged(symbols.size(), false); // FIRST 或可空性发生变化的符号
+    for (int A = 0; A < N; ++A) {
+        first[A + T] = sets[A];
+        firstChanged[A + T] = !known[A] || sets[A] != oldFirst[A] || nullable[A + T] != oldNullable[A];
+    }
+    computeSuffixFirst();
+
+    // FOLLOW(B) 依赖 B 的各出现位置之后后缀的 FIRST/可空性，以及后缀可空时的 FOLLOW(左部)。
+    // 起点：右部变化的非终结符在修改前后的产生式中出现的非终结符，以及后缀中含有 FIRST 变化符号的出现位置
+    deps = QVector<QVector<int>>(N);
+    users = QVector<QVector<int>>(N);
+    sets = QVector<TerminalSet>(N, TerminalSet(T));
+    affected = QVector<bool>(N, false);
+    if (startSymbol >= 0) sets[startSymbol - T].insert(EndMarker);
+    for (int A = 0; A < N; ++A) {
+        if (!prodsChanged[A] || !known[A]) continue;
+        for (int pid : previous.prodsByLeft[oldId[A + T]]) {
+            for (int X : oldRight(pid)) {
+                if (isNonTerminal(X)) affected[X - T] = true;
+            }
+        }
+    }
+    for (const Production &p : productions) {
+        bool suffixChanged = prodsChanged[p.left - T];
+        for (int i = p.right.size() - 1; i >= 0; --i) {
+            int X = p.right[i];
+            if (isNonTerminal(X)) {
+                sets[X - T].unite(suffixFirst(p.id, i + 1));
+                if (suffixNullable(p.id, i + 1) && X != p.left) {
+                    deps[X - T].append(p.left - T);
+                    users[p.left - T].append(X - T);
+                }
+                if (suffixChanged) affected[X - T] = true;
+            }
+            suffixChanged |= firstChanged[X];
+        }
+    }
+    propagateAffected(users, affected);
+    solveAffectedEquations(deps, sets, affected, oldFollow);
+
+    follow = QVector<TerminalSet>(symbols.size(), TerminalSet(T));
+    for (int A = 0; A < N; ++A) {
+        follow[A + T] = sets[A];
+    }
+    return true;
 }
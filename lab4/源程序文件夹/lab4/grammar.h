@@ -4,35 +4,122 @@
 #include <QString>
 #include <QVector>
 #include <QSet>
-#include <QMap>
+#include <QHash>
 #include <QList>
+#include <QStringList>
+
+#include "terminalset.h"
+
+// 符号表：把文法符号映射为稠密整数编号。
+// 终结符占 [0, terminalCount)，其中 0 号固定为结束符 #；
+// 非终结符占 [terminalCount, size())。分析器内部只使用编号，名字只在界面上解析。
+struct SymbolTable {
+    QVector<QString> names;      // id -> name
+    QHash<QString, int> ids;     // name -> id
+    int terminalCount = 0;
+
+    int size() const { return names.size(); }
+    int nonTerminalCount() const { return names.size() - terminalCount; }
+    bool isTerminal(int id) const { return id >= 0 && id < terminalCount; }
+    bool isNonTerminal(int id) const { return id >= terminalCount && id < names.size(); }
+    int id(const QString &name) const { return ids.value(name, -1); }
+    const QString &name(int id) const { return names[id]; }
+
+    void clear();
+    int addTerminal(const QString &name);    // 只能在添加第一个非终结符之前调用
+    int addNonTerminal(const QString &name);
+};
 
 struct Production {
     int id;
-    QString left;
-    QList<QString> right;
+    int left;              // 非终结符编号
+    QVector<int> right;    // 空表示 @
+    int precedence = 0;    // %prec 指定的或右部最后一个终结符的优先级，0 表示没有
+};
+
+// %left/%right/%nonassoc 声明的优先级：后声明的行 level 更高，0 表示未声明
+struct Precedence {
+    enum Assoc { Left, Right, NonAssoc };
+    int level = 0;
+    Assoc assoc = Left;
+};
+
+// removeUselessSymbols 删去的内容，均为删除前的名字/文本
+struct GrammarReduction {
+    QStringList unproductive;  // 推不出终结符串的非终结符
+    QStringList unreachable;   // 从开始符号不可达的符号（终结符与非终结符）
+    QStringList productions;   // 被删去的产生式
+
+    bool isEmpty() const { return productions.isEmpty() && unproductive.isEmpty() && unreachable.isEmpty(); }
+    QString toString() const; // 多行说明，没有删去任何内容时为空
 };
 
 struct Grammar {
-    QString startSymbol;
-    QSet<QString> nonTerminals;
-    QSet<QString> terminals;
+    static constexpr int EndMarker = 0; // 结束符 # 的编号
+
+    SymbolTable symbols;
+    int startSymbol = -1;
     QVector<Production> productions;
-    QMap<QString, QList<int>> prodsByLeft; // left -> production indices
+    QVector<QVector<int>> prodsByLeft; // symbol id -> production indices（终结符为空）
 
     QString epsilon = "@";
     QString endMarker = "#";
 
+    QVector<Precedence> terminalPrecedence; // 终结符编号 -> 优先级
+
+    // 每行一条产生式 A -> α | β；以 %left、%right、%nonassoc 开头的行按 yacc 的写法声明终结符的
+    // 优先级与结合性，候选式末尾的 %prec X 指定该产生式使用 X 的优先级（X 可以只在声明中出现）
     bool parseFromText(const QString &text, QString &errorMsg);
+    // 按文法的分词规则切分符号串（产生式右部与待分析句子共用）
+    static QStringList splitSymbols(const QString &text);
+
+    // 删去无用符号及含有它们的产生式：先删非产生的非终结符，再删从开始符号不可达的符号，
+    // 两步都是对产生式总长线性的工作表算法。开始符号总是保留（语言为空时它没有产生式）。
+    // 剩余符号与产生式按原顺序重新编号，FIRST/FOLLOW 被清空，需随后重新计算
+    GrammarReduction removeUselessSymbols();
+
+    bool isTerminal(int sym) const { return symbols.isTerminal(sym); }
+    bool isNonTerminal(int sym) const { return symbols.isNonTerminal(sym); }
+    const QString &symbolName(int sym) const { return symbols.name(sym); }
+    QString productionToString(int prodId) const;
 
-    QMap<QString, QSet<QString>> first;
-    QMap<QString, QSet<QString>> follow;
+    // 移进 terminal 与按 prodId 归约在同一格时按优先级裁决：优先级高者胜，相同时左结合归约、
+    // 右结合移进、非结合两者都不要（该格为出错）；任一方没有优先级时为 Unresolved，照常报告冲突
+    enum class ShiftReduce { Unresolved, Shift, Reduce, Error };
+    ShiftReduce resolveShiftReduce(int prodId, int terminal) const;
 
+    // 新增一个非终结符（用于增广）；FIRST/FOLLOW 需随后重新计算
+    int addNonTerminal(const QString &name);
+
+    // FIRST/FOLLOW 按符号编号索引，是终结符编号上的位图；ε 由 nullable 表示
+    QVector<TerminalSet> first;
+    QVector<TerminalSet> follow;
+    QVector<bool> nullable;
+
+    // 两者都沿依赖图的强连通分量按拓扑序求解，每个分量只处理一遍
+    void computeNullable();    // 由 computeFirst 调用
     void computeFirst();
     void computeFollow();
+    void computeSuffixFirst(); // 由 computeFirst 调用
 
-    // 提供给 LR(1) 构造使用
-    QSet<QString> firstOfSequence(const QList<QString> &seq, bool &canDeriveEpsilon) const;
+    // 增量更新：previous 为修改前、已求过 FIRST/FOLLOW 的文法。新旧符号按名字对应（增删、重排符号都可以），
+    // 只对可能受修改影响的非终结符重新求解，其余沿用 previous 的结果换算到新编号；
+    // 开始符号改名或 previous 尚未求过 FIRST/FOLLOW 时整体重新计算。
+    // 返回是否按增量方式完成
+    bool updateFirstFollow(const Grammar &previous);
+
+    // 产生式右部每个后缀 right[from..]（from ∈ [0, |right|]）的 FIRST 与可空性，
+    // 由 computeSuffixFirst 一次求出；FOLLOW 与 LR(1) 闭包直接查表
+    QVector<int> suffixOffset;           // 产生式 id -> 该产生式的后缀在下面两个数组中的起始位置
+    QVector<TerminalSet> suffixFirsts;
+    QVector<bool> suffixNullables;
+    const TerminalSet &suffixFirst(int prodId, int from) const { return suffixFirsts[suffixOffset[prodId] + from]; }
+    bool suffixNullable(int prodId, int from) const { return suffixNullables[suffixOffset[prodId] + from]; }
 };
 
+// 求解集合方程组 X[v] = sets[v] ∪ ⋃{ X[w] | w ∈ deps[v] }，结果写回 sets。
+// 按依赖图的强连通分量求解（即 DeRemer–Pennello 的 digraph 算法），
+// FIRST/FOLLOW 与 LALR(1) 的 Read/Follow 都用它
+void solveSetEquations(const QVector<QVector<int>> &deps, QVector<TerminalSet> &sets);
+
 #endif // GRAMMAR_H
@@ -9,15 +9,30 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    buildtask.cpp \
+    codegen.cpp \
+    compiledtable.cpp \
+    glrparser.cpp \
     grammar.cpp \
     lr.cpp \
+    lrparser.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    tablecache.cpp \
+    tablemodels.cpp
 
 HEADERS += \
+    buildtask.h \
+    codegen.h \
+    compiledtable.h \
+    glrparser.h \
     grammar.h \
     lr.h \
-    mainwindow.h
+    lrparser.h \
+    mainwindow.h \
+    tablecache.h \
+    tablemodels.h \
+    terminalset.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,106 @@
+#include "llparser.h"
+
+#include <QObject>
+
+void LL1Table::build(const Grammar &g)
+{
+    terminalCount = g.symbols.terminalCount;
+    startSymbol = g.startSymbol;
+    table = QVector<int>(g.symbols.nonTerminalCount() * terminalCount, -1);
+    conflicts.clear();
+
+    rightStart.resize(g.productions.size() + 1);
+    rightSymbols.clear();
+    for (const Production &p : g.productions) {
+        rightStart[p.id] = rightSymbols.size();
+        for (int i = p.right.size() - 1; i >= 0; --i) rightSymbols.append(p.right[i]);
+    }
+    rightStart[g.productions.size()] = rightSymbols.size();
+
+    auto setEntry = [&](int A, int a, int prodId) {
+        int &cell = table[(A - terminalCount) * terminalCount + a];
+        if (cell < 0 || cell == prodId) {
+            cell = prodId;
+            return;
+        }
+        ConflictInfo c;
+        c.description = QObject::tr("LL(1) 冲突: 非终结符 %1, 符号 %2 上可选产生式 %3 与 %4")
+                            .arg(g.symbolName(A), g.symbolName(a))
+                            .arg(cell).arg(prodId);
+        conflicts.append(c);
+    };
+
+    for (const Production &p : g.productions) {
+        g.suffixFirst(p.id, 0).forEach([&](int a) { setEntry(p.left, a, p.id); });
+        if (g.suffixNullable(p.id, 0)) {
+            g.follow[p.left].forEach([&](int b) { setEntry(p.left, b, p.id); });
+        }
+    }
+}
+
+int LL1Table::entryCount() const
+{
+    int n = 0;
+    for (int prodId : table) {
+        if (prodId >= 0) ++n;
+    }
+    return n;
+}
+
+LLParser::LLParser(const LL1Table &table)
+    : table(table)
+    , symbolStack(256)
+{
+}
+
+bool LLParser::parse(const QVector<int> &tokens)
+{
+    traceSteps.clear();
+    errorPos = -1;
+
+    int *stack = symbolStack.data();
+    int capacity = symbolStack.size();
+    int top = 0;
+    stack[0] = table.getStartSymbol();
+    int pos = 0;
+    const int T = table.getTerminalCount();
+
+    for (;;) {
+        const int a = tokens[pos];
+        if (top < 0) {
+            if (a == Grammar::EndMarker) return true;
+            errorPos = pos;
+            return false;
+        }
+
+        const int X = stack[top];
+        if (X < T) {
+            if (trace) traceSteps.append(LLParseStep{QVector<int>(stack, stack + top + 1), pos, -1});
+            if (X != a) {
+                errorPos = pos;
+                return false;
+            }
+            --top;
+            ++pos;
+            continue;
+        }
+
+        const int prodId = table.predict(X, a);
+        if (trace) traceSteps.append(LLParseStep{QVector<int>(stack, stack + top + 1), pos, prodId});
+        if (prodId < 0) {
+            errorPos = pos;
+            return false;
+        }
+
+        // 弹出 X，把右部倒序压栈；栈满时加倍
+        const int len = table.productionLength(prodId);
+        if (top + len >= capacity) {
+            symbolStack.resize(qMax(capacity * 2, top + len + 1));
+            stack = symbolStack.data();
+            capacity = symbolStack.size();
+        }
+        const int *rhs = table.reversedRight(prodId);
+        for (int i = 0; i < len; ++i) stack[top + i] = rhs[i];
+        top += len - 1;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef LLPARSER_H
+#define LLPARSER_H
+
+#include "grammar.h"
+#include "lr.h"
+#include <QList>
+#include <QVector>
+
+// LL(1) 预测分析表：M[A, a] 为产生式编号，-1 为出错。
+// 按 (A - 终结符个数) * 终结符个数 + a 存放在一个稠密整数数组中，一次查表只读一个 int；
+// 产生式右部倒序展开成连续数组，预测后整段压栈，不需要再访问 Grammar。
+class LL1Table
+{
+public:
+    // g 须已求 FIRST/FOLLOW。M[A, a] 对 a ∈ FIRST(α) 填 A -> α；α 可空时再对 a ∈ FOLLOW(A) 填入。
+    // 格子冲突时记录 ConflictInfo 并保留先写入的产生式
+    void build(const Grammar &g);
+
+    bool isLL1() const { return conflicts.isEmpty(); }
+    const QList<ConflictInfo>& getConflicts() const { return conflicts; }
+
+    int predict(int nonTerminal, int terminal) const { return table[(nonTerminal - terminalCount) * terminalCount + terminal]; }
+    // 产生式右部倒序：[reversedRight(p), reversedRight(p) + productionLength(p))
+    const int *reversedRight(int prodId) const { return rightSymbols.constData() + rightStart[prodId]; }
+    int productionLength(int prodId) const { return rightStart[prodId + 1] - rightStart[prodId]; }
+
+    int getStartSymbol() const { return startSymbol; }
+    int getTerminalCount() const { return terminalCount; }
+    int entryCount() const; // 非出错格子数
+    int denseEntryCount() const { return table.size(); }
+
+private:
+    int terminalCount = 0;
+    int startSymbol = -1;
+    QVector<int> table;
+    QVector<int> rightStart; // 产生式 id -> rightSymbols 中的起始位置，末尾多一项
+    QVector<int> rightSymbols;
+    QList<ConflictInfo> conflicts;
+};
+
+// 分析过程中的一步（仅在开启跟踪时记录）
+struct LLParseStep {
+    QVector<int> stack; // 分析栈，栈顶在末尾
+    int inputPos;       // 当前输入位置
+    int prodId;         // 本步使用的产生式，匹配终结符时为 -1
+};
+
+// 非递归的预测分析驱动。与 LRParser 一样，符号栈预先分配并在多次分析之间复用，
+// 不跟踪时每一步只有一次查表和栈操作
+class LLParser
+{
+public:
+    explicit LLParser(const LL1Table &table);
+
+    void setTrace(bool on) { trace = on; }
+
+    // tokens 为终结符编号序列，须以 Grammar::EndMarker 结尾（可用 LRParser::tokenize 得到）
+    bool parse(const QVector<int> &tokens);
+
+    int errorPosition() const { return errorPos; } // 出错时的输入位置，接受时为 -1
+    const QVector<LLParseStep>& steps() const { return traceSteps; }
+
+private:
+    const LL1Table &table;
+    QVector<int> symbolStack;
+    bool trace = false;
+    QVector<LLParseStep> traceSteps;
+    int errorPos = -1;
+};
+
+#endif // LLPARSER_H
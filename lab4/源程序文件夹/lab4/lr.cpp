@@ -1,80 +1,106 @@
 #include "lr.h"
 
-#include <QQueue>
+#include <QAtomicInt>
+#include <QMutex>
 #include <QObject>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QThread>
+#include <QWaitCondition>
+#include <algorithm>
+#include <vector>
 
 LRAnalyzer::LRAnalyzer(const Grammar &g)
     : grammar(g)
 {
 }
 
+void LRAnalyzer::setBuildMonitor(std::function<void(int, int)> progress, const QAtomicInt *cancel)
+{
+    progressHandler = std::move(progress);
+    cancelToken = cancel;
+}
+
+bool LRAnalyzer::checkpoint(int discovered, int queued)
+{
+    if (progressHandler) progressHandler(discovered, queued);
+    if (cancelRequested()) cancelled = true;
+    return cancelled;
+}
+
 void LRAnalyzer::buildAugmentedGrammar()
 {
+    cancelled = false;
     augmentedGrammar = grammar;
     augmentedStartProdId = -1;
+    if (grammar.startSymbol < 0) return;
 
     // 若文法已是形如 A' -> A 的增广形式，则直接使用
-    if (!grammar.startSymbol.isEmpty()) {
-        const QList<int> &list = grammar.prodsByLeft.value(grammar.startSymbol);
-        if (list.size() == 1) {
-            int pid = list[0];
-            const Production &p0 = grammar.productions[pid];
-            if (p0.right.size() == 1) {
-                const QString &B = p0.right[0];
-                if (grammar.nonTerminals.contains(B) && B != grammar.startSymbol && !grammar.prodsByLeft.value(B).isEmpty()) {
-                    // 认为 grammar 已经是增广文法：startSymbol -> B
-                    augmentedStartProdId = pid;
-                    return;
+    const QVector<int> &list = grammar.prodsByLeft[grammar.startSymbol];
+    if (list.size() == 1) {
+        int pid = list[0];
+        const Production &p0 = grammar.productions[pid];
+        if (p0.right.size() == 1) {
+            int B = p0.right[0];
+            if (grammar.isNonTerminal(B) && B != grammar.startSymbol && !grammar.prodsByLeft[B].isEmpty()) {
+                // 认为 grammar 已经是增广文法：startSymbol -> B
+                augmentedStartProdId = pid;
+                if (augmentedGrammar.follow.size() != augmentedGrammar.symbols.size()) {
+                    augmentedGrammar.computeFirst();
+                    augmentedGrammar.computeFollow();
                 }
+                return;
             }
         }
     }
 
     // 否则自动增广：S' -> S
-    if (grammar.startSymbol.isEmpty()) return;
-    QString newStart = grammar.startSymbol + "'";
-    while (augmentedGrammar.nonTerminals.contains(newStart)) {
+    QString newStart = grammar.symbolName(grammar.startSymbol) + "'";
+    while (augmentedGrammar.symbols.id(newStart) != -1) {
         newStart.append("'");
     }
-    augmentedGrammar.nonTerminals.insert(newStart);
     Production p;
     p.id = augmentedGrammar.productions.size();
-    p.left = newStart;
-    p.right = QList<QString>({grammar.startSymbol});
+    p.left = augmentedGrammar.addNonTerminal(newStart);
+    p.right = QVector<int>({grammar.startSymbol});
     augmentedStartProdId = p.id;
     augmentedGrammar.productions.append(p);
-    augmentedGrammar.prodsByLeft[newStart].append(p.id);
-    augmentedGrammar.startSymbol = newStart;
+    augmentedGrammar.prodsByLeft[p.left].append(p.id);
+    augmentedGrammar.startSymbol = p.left;
+
+    // 新增了开始符号，FIRST/FOLLOW 在增广文法上重新计算
+    augmentedGrammar.computeFirst();
+    augmentedGrammar.computeFollow();
 }
 
 QSet<LR0Item> LRAnalyzer::closureLR0(const QSet<LR0Item> &I) const
 {
+    // 工作表算法：每个新加入的项目只处理一次，每个非终结符只展开一次
     QSet<LR0Item> result = I;
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        QList<LR0Item> items = result.values();
-        for (const LR0Item &item : items) {
-            const Production &p = augmentedGrammar.productions[item.prodId];
-            if (item.dotPos < p.right.size()) {
-                QString B = p.right[item.dotPos];
-                if (augmentedGrammar.nonTerminals.contains(B)) {
-                    const QList<int> &plist = augmentedGrammar.prodsByLeft[B];
-                    for (int pid : plist) {
-                        LR0Item newItem{pid, 0};
-                        if (!result.contains(newItem)) {
-                            result.insert(newItem);
-                            changed = true;
-                        }
-                    }
-                }
+    QSet<int> expanded;
+    QVector<LR0Item> work(I.begin(), I.end());
+    while (!work.isEmpty()) {
+        const LR0Item item = work.takeLast();
+        const Production &p = augmentedGrammar.productions[item.prodId];
+        if (item.dotPos >= p.right.size()) continue;
+
+        int B = p.right[item.dotPos];
+        if (!augmentedGrammar.isNonTerminal(B) || expanded.contains(B)) continue;
+        expanded.insert(B);
+
+        const QVector<int> &plist = augmentedGrammar.prodsByLeft[B];
+        for (int pid : plist) {
+            LR0Item newItem{pid, 0};
+            if (!result.contains(newItem)) {
+                result.insert(newItem);
+                work.append(newItem);
             }
         }
     }
     return result;
 }
 
-QSet<LR0Item> LRAnalyzer::gotoLR0(const QSet<LR0Item> &I, const QString &X) const
+QSet<LR0Item> LRAnalyzer::gotoLR0(const QSet<LR0Item> &I, int X) const
 {
     QSet<LR0Item> J;
     for (const LR0Item &item : I) {
@@ -88,59 +114,156 @@ QSet<LR0Item> LRAnalyzer::gotoLR0(const QSet<LR0Item> &I, const QString &X) cons
     return closureLR0(J);
 }
 
+QMap<int, LR0Kernel> LRAnalyzer::gotoKernelsLR0(const QSet<LR0Item> &I) const
+{
+    QMap<int, LR0Kernel> kernels;
+    for (const LR0Item &item : I) {
+        const Production &p = augmentedGrammar.productions[item.prodId];
+        if (item.dotPos < p.right.size()) {
+            kernels[p.right[item.dotPos]].insert(LR0Item{item.prodId, item.dotPos + 1});
+        }
+    }
+    return kernels;
+}
+
 void LRAnalyzer::buildLR0()
 {
     buildAugmentedGrammar();
     lr0States.clear();
+    lr0KernelIndex.clear();
 
     // 初始项目集 I0
-    QSet<LR0Item> I0;
-    I0.insert(LR0Item{augmentedStartProdId, 0});
-    I0 = closureLR0(I0);
+    LR0Kernel K0;
+    K0.insert(LR0Item{augmentedStartProdId, 0});
 
-    QVector<QSet<LR0Item>> C; // states as item sets
-    C.append(I0);
     LR0State s0;
     s0.id = 0;
-    s0.items = I0;
+    s0.kernel = K0;
     lr0States.append(s0);
+    lr0KernelIndex.insert(K0, 0);
 
     QQueue<int> q;
     q.enqueue(0);
 
     while (!q.isEmpty()) {
         int si = q.dequeue();
-        QSet<LR0Item> I = lr0States[si].items;
-
-        QSet<QString> symbols;
-        for (const LR0Item &item : I) {
-            const Production &p = augmentedGrammar.productions[item.prodId];
-            if (item.dotPos < p.right.size()) {
-                symbols.insert(p.right[item.dotPos]);
-            }
-        }
+        const QMap<int, LR0Kernel> kernels = gotoKernelsLR0(closureLR0(lr0States[si].kernel));
 
-        for (const QString &X : symbols) {
-            QSet<LR0Item> J = gotoLR0(I, X);
-            if (J.isEmpty()) continue;
+        for (auto it = kernels.begin(); it != kernels.end(); ++it) {
+            int X = it.key();
+            const LR0Kernel &K = it.value();
 
-            int existing = -1;
-            for (int i = 0; i < lr0States.size(); ++i) {
-                if (lr0States[i].items == J) {
-                    existing = i;
-                    break;
-                }
-            }
+            // 按内核查重；状态只保存内核，闭包在出队处理时临时求出
+            int existing = lr0KernelIndex.value(K, -1);
             if (existing == -1) {
                 LR0State s;
                 s.id = lr0States.size();
-                s.items = J;
+                s.kernel = K;
                 lr0States.append(s);
+                lr0KernelIndex.insert(K, s.id);
                 existing = s.id;
                 q.enqueue(existing);
             }
             lr0States[si].transitions[X] = existing;
         }
+        if (checkpoint(lr0States.size(), q.size())) {
+            lr0States.clear();
+            lr0KernelIndex.clear();
+            return;
+        }
+    }
+}
+
+void LRAnalyzer::setAction(LRTable &table, QList<ConflictInfo> &conflicts, const QString &mode,
+                           int state, int term, const ActionEntry &entry) const
+{
+    ActionEntry &cell = table.action[state][term];
+    if (cell.type == ActionEntry::None || (cell.type == entry.type && cell.target == entry.target)) {
+        cell = entry;
+        return;
+    }
+
+    // 格子里已有不同动作：记录冲突，保留原动作
+    ConflictInfo c;
+    if (entry.type == ActionEntry::Shift) {
+        c.description = QObject::tr("%1 冲突: 状态 %2, 符号 %3 发生移进冲突").arg(mode).arg(state).arg(augmentedGrammar.symbolName(term));
+    } else if (entry.type == ActionEntry::Reduce) {
+        c.description = QObject::tr("%1 冲突: 状态 %2, 符号 %3 上产生归约冲突").arg(mode).arg(state).arg(augmentedGrammar.symbolName(term));
+    } else {
+        c.description = QObject::tr("%1 冲突: 状态 %2 上存在接受/其它动作冲突").arg(mode).arg(state);
+    }
+    conflicts.append(c);
+}
+
+void LRAnalyzer::fillShiftsAndGotos(LRTable &table, QList<ConflictInfo> &conflicts, const QString &mode,
+                                    int state, const QMap<int, int> &transitions) const
+{
+    for (auto it = transitions.begin(); it != transitions.end(); ++it) {
+        int X = it.key();
+        int j = it.value();
+        if (augmentedGrammar.isTerminal(X)) {
+            ActionEntry entry;
+            entry.type = ActionEntry::Shift;
+            entry.target = j;
+            setAction(table, conflicts, mode, state, X, entry);
+        } else {
+            table.goTo[state][X] = j;
+        }
+    }
+}
+
+void LRAnalyzer::fillReduceActions(LRTable &table, QList<ConflictInfo> &conflicts, const QString &mode,
+                                   int state, const QMap<int, TerminalSet> &reductions) const
+{
+    // 已有移进的终结符 -> 在它上面归约的产生式，等该状态的归约全部收齐后再按优先级裁决
+    QMap<int, QVector<int>> contested;
+    const QMap<int, ActionEntry> &row = table.action[state];
+    for (auto it = reductions.begin(); it != reductions.end(); ++it) {
+        const int prodId = it.key();
+        if (prodId == augmentedStartProdId) {
+            // S' -> S.
+            if (it.value().contains(Grammar::EndMarker)) {
+                setAction(table, conflicts, mode, state, Grammar::EndMarker, ActionEntry{ActionEntry::Accept, -1});
+            }
+            continue;
+        }
+        it.value().forEach([&](int a) {
+            auto cell = row.find(a);
+            if (cell != row.end() && cell.value().type == ActionEntry::Shift) contested[a].append(prodId);
+            else setAction(table, conflicts, mode, state, a, ActionEntry{ActionEntry::Reduce, prodId});
+        });
+    }
+
+    // 每个归约各自与移进比较：输给移进或 %nonassoc 的归约去掉；只有所有归约都胜过移进时才去掉移进，
+    // 全部是 %nonassoc 时该格为出错。留下的动作多于一个时照常记录冲突
+    for (auto it = contested.begin(); it != contested.end(); ++it) {
+        const int a = it.key();
+        bool shiftBeaten = true;
+        QVector<int> survivors;
+        for (int prodId : it.value()) {
+            switch (augmentedGrammar.resolveShiftReduce(prodId, a)) {
+            case Grammar::ShiftReduce::Shift:
+                shiftBeaten = false;
+                break;
+            case Grammar::ShiftReduce::Reduce:
+                survivors.append(prodId);
+                break;
+            case Grammar::ShiftReduce::Error:
+                break;
+            case Grammar::ShiftReduce::Unresolved:
+                shiftBeaten = false;
+                survivors.append(prodId);
+                break;
+            }
+        }
+        int k = 0;
+        if (shiftBeaten) {
+            table.action[state][a] = survivors.isEmpty() ? ActionEntry{ActionEntry::Error, -1}
+                                                         : ActionEntry{ActionEntry::Reduce, survivors[k++]};
+        }
+        for (; k < survivors.size(); ++k) {
+            setAction(table, conflicts, mode, state, a, ActionEntry{ActionEntry::Reduce, survivors[k]});
+        }
     }
 }
 
@@ -150,251 +273,1136 @@ void LRAnalyzer::buildSLRTable()
     slrTable.goTo.clear();
     slrConflicts.clear();
 
-    // 确保 FOLLOW 已计算
-    if (augmentedGrammar.follow.isEmpty()) {
-        augmentedGrammar.computeFirst();
-        augmentedGrammar.computeFollow();
+    const QString mode = "SLR";
+    TerminalSet endOnly(augmentedGrammar.symbols.terminalCount);
+    endOnly.insert(Grammar::EndMarker);
+
+    for (const LR0State &state : lr0States) {
+        // 移进和 goto
+        fillShiftsAndGotos(slrTable, slrConflicts, mode, state.id, state.transitions);
+
+        // 归约和接收：对 FOLLOW(A) 中的每个 a，设置 reduce
+        QMap<int, TerminalSet> reductions;
+        const QSet<LR0Item> items = closureLR0(state.kernel);
+        for (const LR0Item &item : items) {
+            const Production &p = augmentedGrammar.productions[item.prodId];
+            if (item.dotPos == p.right.size()) {
+                reductions.insert(item.prodId, item.prodId == augmentedStartProdId ? endOnly : augmentedGrammar.follow[p.left]);
+            }
+        }
+        fillReduceActions(slrTable, slrConflicts, mode, state.id, reductions);
     }
+}
+
+void LRAnalyzer::buildLALRTable()
+{
+    lalrTable.action.clear();
+    lalrTable.goTo.clear();
+    lalrConflicts.clear();
+    lalrLookaheads.clear();
 
-    // 终结符集合包含 endMarker
-    QSet<QString> terminals = augmentedGrammar.terminals;
-    terminals.insert(augmentedGrammar.endMarker);
+    // DeRemer–Pennello 算法，在 LR(0) 自动机上计算 LALR(1) 向前看集合：
+    //   DR(p,A)     = { t | goto(goto(p,A), t) 存在 }
+    //   (p,A) reads (r,C)       当 r = goto(p,A) 且 C 可空
+    //   (p,A) includes (p',B)   当 B -> β A γ，γ 可空，且 p' 经 β 到达 p
+    //   (q,A->ω) lookback (p,A) 当 p 经 ω 到达 q
+    //   Read = DR ∪ ⋃Read(reads)，Follow = Read ∪ ⋃Follow(includes)，
+    //   LA(q,A->ω) = ⋃{ Follow(p,A) | (q,A->ω) lookback (p,A) }
+    // 两次传递闭包都是集合方程组，用 solveSetEquations（强连通分量）求解。
+    const Grammar &g = augmentedGrammar;
+    const int T = g.symbols.terminalCount;
 
+    // 1. 给所有非终结符转移 (p,A) 编号
+    QHash<QPair<int, int>, int> ntIndex;
+    QVector<QPair<int, int>> ntTrans;
     for (const LR0State &state : lr0States) {
-        int i = state.id;
-        // 移进
         for (auto it = state.transitions.begin(); it != state.transitions.end(); ++it) {
-            QString X = it.key();
-            int j = it.value();
-            if (augmentedGrammar.terminals.contains(X)) {
-                ActionEntry entry;
-                entry.type = ActionEntry::Shift;
-                entry.target = j;
-                ActionEntry &cell = slrTable.action[i][X];
-                if (cell.type != ActionEntry::None && !(cell.type == entry.type && cell.target == entry.target)) {
-                    ConflictInfo c;
-                    c.description = QObject::tr("SLR 冲突: 状态 %1, 符号 %2 发生移进冲突").arg(i).arg(X);
-                    slrConflicts.append(c);
-                } else {
-                    cell = entry;
+            if (g.isNonTerminal(it.key())) {
+                ntIndex.insert(qMakePair(state.id, it.key()), ntTrans.size());
+                ntTrans.append(qMakePair(state.id, it.key()));
+            }
+        }
+    }
+    const int n = ntTrans.size();
+
+    // 2. DR 与 reads
+    QVector<TerminalSet> sets(n, TerminalSet(T));
+    QVector<QVector<int>> reads(n);
+    const LR0Item acceptItem{augmentedStartProdId, 1};
+    for (int x = 0; x < n; ++x) {
+        const LR0State &r = lr0States[lr0States[ntTrans[x].first].transitions.value(ntTrans[x].second)];
+        for (auto it = r.transitions.begin(); it != r.transitions.end(); ++it) {
+            int C = it.key();
+            if (g.isTerminal(C)) {
+                sets[x].insert(C);
+            } else if (g.nullable[C]) {
+                reads[x].append(ntIndex.value(qMakePair(r.id, C)));
+            }
+        }
+        // S' -> S· 所在状态上的 # 相当于一次 # 移进
+        if (r.kernel.contains(acceptItem)) sets[x].insert(Grammar::EndMarker);
+    }
+    solveSetEquations(reads, sets); // sets = Read
+
+    // 3. includes 与 lookback：从每个 (p',B) 出发沿 B 的每个产生式走一遍
+    QVector<QVector<int>> includes(n);
+    QHash<QPair<int, int>, QVector<int>> lookback; // (q, prodId) -> 非终结符转移
+    for (int x = 0; x < n; ++x) {
+        int start = ntTrans[x].first;
+        int B = ntTrans[x].second;
+        for (int pid : g.prodsByLeft[B]) {
+            const Production &p = g.productions[pid];
+            // nullableFrom：最小的 k，使 right[k..] 全部可空
+            int nullableFrom = p.right.size();
+            while (nullableFrom > 0 && g.nullable[p.right[nullableFrom - 1]]) --nullableFrom;
+
+            int q = start;
+            for (int i = 0; i < p.right.size(); ++i) {
+                int X = p.right[i];
+                if (g.isNonTerminal(X) && i + 1 >= nullableFrom) {
+                    includes[ntIndex.value(qMakePair(q, X))].append(x);
                 }
-            } else if (augmentedGrammar.nonTerminals.contains(X)) {
-                slrTable.goTo[i][X] = j;
+                q = lr0States[q].transitions.value(X);
             }
+            lookback[qMakePair(q, pid)].append(x);
         }
+    }
+    solveSetEquations(includes, sets); // sets = Follow
 
-        // 归约和接收
-        for (const LR0Item &item : state.items) {
-            const Production &p = augmentedGrammar.productions[item.prodId];
+    // 4. 汇总每个 (状态, 产生式) 的向前看集合并填表
+    for (auto it = lookback.begin(); it != lookback.end(); ++it) {
+        TerminalSet la(T);
+        for (int x : it.value()) la.unite(sets[x]);
+        lalrLookaheads.insert(it.key(), la);
+    }
+
+    const QString mode = "LALR(1)";
+    TerminalSet endOnly(T);
+    endOnly.insert(Grammar::EndMarker);
+    for (const LR0State &state : lr0States) {
+        fillShiftsAndGotos(lalrTable, lalrConflicts, mode, state.id, state.transitions);
+
+        QMap<int, TerminalSet> reductions;
+        const QSet<LR0Item> items = closureLR0(state.kernel);
+        for (const LR0Item &item : items) {
+            const Production &p = g.productions[item.prodId];
             if (item.dotPos == p.right.size()) {
-                if (item.prodId == augmentedStartProdId) {
-                    // S' -> S.
-                    ActionEntry entry;
-                    entry.type = ActionEntry::Accept;
-                    ActionEntry &cell = slrTable.action[i][augmentedGrammar.endMarker];
-                    if (cell.type != ActionEntry::None && cell.type != ActionEntry::Accept) {
-                        ConflictInfo c;
-                        c.description = QObject::tr("SLR 冲突: 状态 %1 上存在接受/其它动作冲突").arg(i);
-                        slrConflicts.append(c);
-                    } else {
-                        cell = entry;
-                    }
-                } else {
-                    // 对 FOLLOW(A) 中的每个 a，设置 reduce
-                    const QString &A = p.left;
-                    const QSet<QString> &followA = augmentedGrammar.follow[A];
-                    for (const QString &a : followA) {
-                        ActionEntry entry;
-                        entry.type = ActionEntry::Reduce;
-                        entry.target = item.prodId;
-                        ActionEntry &cell = slrTable.action[i][a];
-                        if (cell.type != ActionEntry::None && !(cell.type == entry.type && cell.target == entry.target)) {
-                            ConflictInfo c;
-                            c.description = QObject::tr("SLR 冲突: 状态 %1, 符号 %2 上产生归约冲突").arg(i).arg(a);
-                            slrConflicts.append(c);
-                        } else {
-                            cell = entry;
-                        }
-                    }
-                }
+                reductions.insert(item.prodId, item.prodId == augmentedStartProdId ? endOnly : lalrLookahead(state.id, item.prodId));
             }
         }
+        fillReduceActions(lalrTable, lalrConflicts, mode, state.id, reductions);
     }
 }
 
-QSet<LR1Item> LRAnalyzer::closureLR1(const QSet<LR1Item> &I) const
+TerminalSet LRAnalyzer::lalrLookahead(int stateId, int prodId) const
 {
-    QSet<LR1Item> result = I;
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        QList<LR1Item> items = result.values();
-        for (const LR1Item &item : items) {
-            const Production &p = augmentedGrammar.productions[item.prodId];
-            if (item.dotPos < p.right.size()) {
-                QString B = p.right[item.dotPos];
-                if (augmentedGrammar.nonTerminals.contains(B)) {
-                    // 计算 FIRST(beta a)
-                    QList<QString> beta;
-                    for (int k = item.dotPos + 1; k < p.right.size(); ++k) {
-                        beta.append(p.right[k]);
-                    }
-                    beta.append(item.lookahead);
-
-                    bool nullable = false;
-                    QSet<QString> firstSet = augmentedGrammar.firstOfSequence(beta, nullable);
-
-                    const QList<int> &plist = augmentedGrammar.prodsByLeft[B];
-                    for (int pid : plist) {
-                        for (const QString &b : firstSet) {
-                            if (b == augmentedGrammar.epsilon) continue;
-                            LR1Item newItem{pid, 0, b};
-                            if (!result.contains(newItem)) {
-                                result.insert(newItem);
-                                changed = true;
-                            }
-                        }
-                    }
-                }
+    return lalrLookaheads.value(qMakePair(stateId, prodId), TerminalSet(augmentedGrammar.symbols.terminalCount));
+}
+
+LR1Closure LRAnalyzer::closureLR1(const LR1Kernel &K) const
+{
+    LR1Closure result;
+    QVector<LR0Item> work;
+    for (auto it = K.begin(); it != K.end(); ++it) {
+        result.insert(it.key(), it.value());
+        work.append(it.key());
+    }
+    while (!work.isEmpty()) {
+        const LR0Item item = work.takeLast();
+        const Production &p = augmentedGrammar.productions[item.prodId];
+        if (item.dotPos >= p.right.size()) continue;
+
+        int B = p.right[item.dotPos];
+        if (!augmentedGrammar.isNonTerminal(B)) continue;
+
+        // FIRST(β a)：β 不可空时直接引用后缀表，否则并上本项目的向前看集合
+        const TerminalSet *firstSet = &augmentedGrammar.suffixFirst(item.prodId, item.dotPos + 1);
+        TerminalSet withLookahead;
+        if (augmentedGrammar.suffixNullable(item.prodId, item.dotPos + 1)) {
+            withLookahead = *firstSet;
+            withLookahead.unite(result.value(item));
+            firstSet = &withLookahead;
+        }
+
+        for (int pid : augmentedGrammar.prodsByLeft[B]) {
+            LR0Item newItem{pid, 0};
+            auto it = result.find(newItem);
+            if (it == result.end()) {
+                result.insert(newItem, *firstSet);
+                work.append(newItem);
+            } else if (it.value().unite(*firstSet)) {
+                work.append(newItem);
             }
         }
     }
     return result;
 }
 
-QSet<LR1Item> LRAnalyzer::gotoLR1(const QSet<LR1Item> &I, const QString &X) const
+namespace {
+
+// 扁平存放的 LR(1) 内核：size 个项目号（升序）及各自的 W 个向前看字
+struct LR1KernelView {
+    const int *items;
+    const quint64 *words;
+    int size;
+};
+
+// LR(1) 构造的工作区，每次构造（多线程时每个线程）一个，构造结束时整体释放。
+// LR(0) 项目 (产生式 p, 点位置 d) 编为稠密号 suffixOffset[p] + d，项目号的顺序与 LR0Item 的顺序一致；
+// 向前看集合按 W 个 64 位字存放。闭包是按项目号索引的两块扁平数组，goto 内核按符号分组写进连续缓冲区，
+// 这些数组只随文法规模分配一次，之后每个状态复用，不再为每个项目、每个集合单独分配
+class LR1Workspace
 {
-    QSet<LR1Item> J;
-    for (const LR1Item &item : I) {
-        const Production &p = augmentedGrammar.productions[item.prodId];
-        if (item.dotPos < p.right.size() && p.right[item.dotPos] == X) {
-            LR1Item moved{item.prodId, item.dotPos + 1, item.lookahead};
-            J.insert(moved);
+public:
+    explicit LR1Workspace(const Grammar &g)
+        : g(g), W((g.symbols.terminalCount + 63) / 64)
+    {
+        const int itemCount = g.suffixFirsts.size();
+        itemProd.resize(itemCount);
+        itemDot.resize(itemCount);
+        nextSymbol.resize(itemCount);
+        firstWords.fill(0, itemCount * W);
+        nullableAfter.resize(itemCount);
+        for (const Production &p : g.productions) {
+            const int base = g.suffixOffset[p.id];
+            for (int d = 0; d <= p.right.size(); ++d) {
+                itemProd[base + d] = p.id;
+                itemDot[base + d] = d;
+                nextSymbol[base + d] = d < p.right.size() ? p.right[d] : -1;
+                copyWords(g.suffixFirst(p.id, d), &firstWords[(base + d) * W]);
+                nullableAfter[base + d] = g.suffixNullable(p.id, d);
+            }
         }
+        lookaheads.fill(0, itemCount * W);
+        present.fill(false, itemCount);
+        buffer.resize(W);
     }
-    if (J.isEmpty()) return J;
-    return closureLR1(J);
-}
+
+    int wordCount() const { return W; }
+
+    // 把 QMap 形式的内核换成扁平形式，结果在下一次调用前有效
+    LR1KernelView view(const LR1Kernel &K)
+    {
+        viewItems.clear();
+        viewWords.clear();
+        for (auto it = K.begin(); it != K.end(); ++it) {
+            viewItems.append(g.suffixOffset[it.key().prodId] + it.key().dotPos);
+            viewWords.resize(viewWords.size() + W);
+            copyWords(it.value(), viewWords.data() + viewWords.size() - W);
+        }
+        return LR1KernelView{viewItems.constData(), viewWords.constData(), int(viewItems.size())};
+    }
+
+    LR1Kernel toKernel(const LR1KernelView &K) const
+    {
+        LR1Kernel result;
+        for (int k = 0; k < K.size; ++k) {
+            const int item = K.items[k];
+            result.insert(LR0Item{itemProd[item], itemDot[item]}, TerminalSet::fromWords(K.words + k * W, W));
+        }
+        return result;
+    }
+
+    // 求 K 的闭包，留在工作区中供 reductions()/forEachSuccessor() 使用
+    void close(const LR1KernelView &K)
+    {
+        for (int item : members) {
+            present[item] = false;
+            std::fill_n(&lookaheads[item * W], W, 0);
+        }
+        members.clear();
+        work.clear();
+        for (int k = 0; k < K.size; ++k) {
+            const int item = K.items[k];
+            present[item] = true;
+            std::copy_n(K.words + k * W, W, &lookaheads[item * W]);
+            members.append(item);
+            work.append(item);
+        }
+        while (!work.isEmpty()) {
+            const int item = work.takeLast();
+            const int B = nextSymbol[item];
+            if (B < 0 || !g.isNonTerminal(B)) continue;
+
+            // FIRST(β a)：β 可空时并上本项目的向前看集合
+            const quint64 *first = &firstWords[(item + 1) * W];
+            if (nullableAfter[item + 1]) {
+                for (int w = 0; w < W; ++w) buffer[w] = first[w] | lookaheads[item * W + w];
+                first = buffer.constData();
+            }
+            for (int pid : g.prodsByLeft[B]) {
+                const int newItem = g.suffixOffset[pid];
+                quint64 *la = &lookaheads[newItem * W];
+                if (!present[newItem]) {
+                    present[newItem] = true;
+                    std::copy_n(first, W, la);
+                    members.append(newItem);
+                    work.append(newItem);
+                    continue;
+                }
+                bool changed = false;
+                for (int w = 0; w < W; ++w) {
+                    const quint64 merged = la[w] | first[w];
+                    changed |= merged != la[w];
+                    la[w] = merged;
+                }
+                if (changed) work.append(newItem);
+            }
+        }
+    }
+
+    // 闭包中的完成项目：产生式 -> 向前看集合
+    QMap<int, TerminalSet> reductions() const
+    {
+        QMap<int, TerminalSet> result;
+        for (int item : members) {
+            if (nextSymbol[item] < 0) result.insert(itemProd[item], TerminalSet::fromWords(&lookaheads[item * W], W));
+        }
+        return result;
+    }
+
+    // 按符号编号从小到大，对闭包的每个 goto 内核调用 fn(X, 内核)。
+    // 点后为 X 的项目各自移进一步就是后继内核，项目号加一，向前看集合不变
+    template <typename Fn>
+    void forEachSuccessor(Fn fn)
+    {
+        keys.clear();
+        for (int item : members) {
+            if (nextSymbol[item] >= 0) keys.append((qint64(nextSymbol[item]) << 32) | (item + 1));
+        }
+        std::sort(keys.begin(), keys.end());
+        successorItems.resize(keys.size());
+        successorWords.resize(keys.size() * W);
+        for (int k = 0; k < keys.size(); ++k) {
+            const int item = int(keys[k] & 0xffffffff);
+            successorItems[k] = item;
+            std::copy_n(&lookaheads[(item - 1) * W], W, &successorWords[k * W]);
+        }
+        for (int begin = 0; begin < keys.size();) {
+            const int X = int(keys[begin] >> 32);
+            int end = begin + 1;
+            while (end < keys.size() && int(keys[end] >> 32) == X) ++end;
+            fn(X, LR1KernelView{&successorItems[begin], &successorWords[begin * W], end - begin});
+            begin = end;
+        }
+    }
+
+private:
+    const Grammar &g;
+    const int W;
+    // 按项目号：产生式、点位置、点后符号（完成项目为 -1）、点后第二个符号起的 FIRST 与可空性
+    QVector<int> itemProd, itemDot, nextSymbol;
+    QVector<quint64> firstWords;
+    QVector<bool> nullableAfter;
+    // 闭包
+    QVector<quint64> lookaheads;
+    QVector<bool> present;
+    QVector<int> members, work;
+    QVector<quint64> buffer;
+    // goto 内核与 view() 的缓冲区
+    QVector<qint64> keys;
+    QVector<int> successorItems, viewItems;
+    QVector<quint64> successorWords, viewWords;
+
+    void copyWords(const TerminalSet &set, quint64 *out) const
+    {
+        const int n = qMin(W, set.wordCount());
+        std::copy_n(set.constData(), n, out);
+        std::fill(out + n, out + W, 0);
+    }
+};
+
+// 已建状态的内核，连续存放在两块数组里；索引为开放定址的哈希表。
+// 查找只读数组，不分配内存；登记时把内核追加到数组末尾
+class LR1KernelStore
+{
+public:
+    explicit LR1KernelStore(int wordCount) : W(wordCount), starts(1, 0), buckets(64, -1) {}
+
+    // 内核对应的编号，没有时为 -1
+    int find(const LR1KernelView &K) const { return find(K, hashOf(K)); }
+    int find(const LR1KernelView &K, size_t hash) const
+    {
+        for (size_t i = hash & (buckets.size() - 1);; i = (i + 1) & (buckets.size() - 1)) {
+            const int e = buckets[i];
+            if (e < 0) return -1;
+            if (hashes[e] == hash && equals(e, K)) return ids[e];
+        }
+    }
+
+    // 登记一个尚未出现过的内核，编号由调用者给出
+    void add(const LR1KernelView &K, int id) { add(K, hashOf(K), id); }
+    void add(const LR1KernelView &K, size_t hash, int id)
+    {
+        const int e = ids.size();
+        items.resize(items.size() + K.size);
+        std::copy_n(K.items, K.size, items.end() - K.size);
+        words.resize(words.size() + K.size * W);
+        std::copy_n(K.words, K.size * W, words.end() - K.size * W);
+        starts.append(items.size());
+        hashes.append(hash);
+        ids.append(id);
+        if (2 * ids.size() > buckets.size()) rehash(2 * buckets.size());
+        else place(e);
+    }
+
+    int count() const { return ids.size(); }
+
+    // 第 e 个登记的内核
+    LR1KernelView entry(int e) const
+    {
+        return LR1KernelView{items.constData() + starts[e], words.constData() + starts[e] * W, starts[e + 1] - starts[e]};
+    }
+
+    size_t hashOf(const LR1KernelView &K) const
+    {
+        return qHashBits(K.words, K.size * W * sizeof(quint64), qHashBits(K.items, K.size * sizeof(int)));
+    }
+
+private:
+    const int W;
+    QVector<int> items;
+    QVector<quint64> words;
+    QVector<int> starts;   // 第 e 个内核在 items 中的起始位置，末尾多一项
+    QVector<size_t> hashes;
+    QVector<int> ids;
+    QVector<int> buckets;    // 大小为 2 的幂，存登记序号，-1 为空
+
+    bool equals(int e, const LR1KernelView &K) const
+    {
+        const int begin = starts[e];
+        return starts[e + 1] - begin == K.size
+               && std::equal(K.items, K.items + K.size, items.constData() + begin)
+               && std::equal(K.words, K.words + K.size * W, words.constData() + begin * W);
+    }
+
+    void place(int e)
+    {
+        size_t i = hashes[e] & (buckets.size() - 1);
+        while (buckets[i] >= 0) i = (i + 1) & (buckets.size() - 1);
+        buckets[i] = e;
+    }
+
+    void rehash(int size)
+    {
+        buckets.fill(-1, size);
+        for (int e = 0; e < ids.size(); ++e) place(e);
+    }
+};
+
+} // namespace
+
+namespace {
+
+// 增量构造时沿用旧自动机的状态。符号按名字对应，产生式按规范文本对应（同文的重复产生式依次配对）。
+// 旧状态 s 可以沿用，当且仅当它的闭包与修改前完全相同（换算编号后）：
+// 内核项目的产生式都还在，点后的非终结符不“脏”，点后第二个及以后的符号 FIRST/可空性不变。
+// 非终结符 B 是脏的，指 B 的右部集合变了，或 B 的某个右部在 1 号及以后位置含 FIRST 变化的符号
+// （决定闭包项目的向前看集合），或 0 号位置是脏的非终结符（其产生式同样进入闭包）
+class LR1Reuse
+{
+public:
+    LR1Reuse(const Grammar &oldG, const Grammar &newG, const QVector<LR1State> &oldStates,
+             const QHash<LR1Kernel, int> &oldIndex)
+        : oldG(oldG), newG(newG), oldStates(oldStates), oldIndex(oldIndex)
+        , clean(oldStates.size(), -1), translated(oldStates.size())
+    {
+        const int oldSymbols = oldG.symbols.size();
+        symbolToNew.fill(-1, oldSymbols);
+        termToNew.fill(-1, oldG.symbols.terminalCount);
+        termToOld.fill(-1, newG.symbols.terminalCount);
+        for (int X = 0; X < oldSymbols; ++X) {
+            const int Y = newG.symbols.id(oldG.symbolName(X));
+            if (Y < 0 || oldG.isTerminal(X) != newG.isTerminal(Y)) continue;
+            symbolToNew[X] = Y;
+            if (oldG.isTerminal(X)) {
+                termToNew[X] = Y;
+                termToOld[Y] = X;
+            }
+        }
+
+        QHash<QString, QVector<int>> newByText;
+        for (int q = newG.productions.size() - 1; q >= 0; --q) newByText[newG.productionToString(q)].append(q);
+        prodToNew.fill(-1, oldG.productions.size());
+        prodToOld.fill(-1, newG.productions.size());
+        for (int p = 0; p < oldG.productions.size(); ++p) {
+            // 文本相同但符号的终结符/非终结符身份变了，也不算同一产生式
+            bool symbolsKept = symbolToNew[oldG.productions[p].left] >= 0;
+            for (int X : oldG.productions[p].right) symbolsKept &= symbolToNew[X] >= 0;
+            if (!symbolsKept) continue;
+            auto it = newByText.find(oldG.productionToString(p));
+            if (it == newByText.end() || it.value().isEmpty()) continue;
+            const int q = it.value().takeLast();
+            prodToNew[p] = q;
+            prodToOld[q] = p;
+        }
+
+        identity = oldG.productions.size() == newG.productions.size()
+                   && oldG.symbols.terminalCount == newG.symbols.terminalCount;
+        for (int p = 0; p < prodToNew.size() && identity; ++p) identity = prodToNew[p] == p;
+        for (int t = 0; t < termToNew.size() && identity; ++t) identity = termToNew[t] == t;
+
+        firstChanged.fill(false, oldSymbols);
+        for (int X = 0; X < oldSymbols; ++X) {
+            const int Y = symbolToNew[X];
+            if (Y < 0) {
+                firstChanged[X] = true;
+                continue;
+            }
+            bool ok = true;
+            const TerminalSet first = translate(oldG.first[X], termToNew, newG.symbols.terminalCount, ok);
+            firstChanged[X] = !ok || first != newG.first[Y] || oldG.nullable[X] != newG.nullable[Y];
+        }
+
+        dirty.fill(false, oldSymbols);
+        QVector<QVector<int>> users(oldSymbols); // X -> 以 X 开头的右部的左部
+        for (int A = oldG.symbols.terminalCount; A < oldSymbols; ++A) {
+            const int B = symbolToNew[A];
+            dirty[A] = B < 0 || oldG.prodsByLeft[A].size() != newG.prodsByLeft[B].size();
+            for (int pid : oldG.prodsByLeft[A]) {
+                const QVector<int> &right = oldG.productions[pid].right;
+                if (prodToNew[pid] < 0) dirty[A] = true;
+                for (int i = 1; i < right.size(); ++i) {
+                    if (firstChanged[right[i]]) dirty[A] = true;
+                }
+                if (!right.isEmpty() && oldG.isNonTerminal(right[0])) users[right[0]].append(A);
+            }
+        }
+        QVector<int> work;
+        for (int A = 0; A < oldSymbols; ++A) {
+            if (dirty[A]) work.append(A);
+        }
+        while (!work.isEmpty()) {
+            const int X = work.takeLast();
+            for (int A : users[X]) {
+                if (!dirty[A]) {
+                    dirty[A] = true;
+                    work.append(A);
+                }
+            }
+        }
+    }
+
+    // 内核 K（新编号）对应的旧状态，没有时为 -1
+    int oldStateOf(const LR1Kernel &K) const
+    {
+        bool ok = true;
+        const LR1Kernel oldK = translate(K, prodToOld, termToOld, oldG.symbols.terminalCount, ok);
+        return ok ? oldIndex.value(oldK, -1) : -1;
+    }
+
+    bool isClean(int s)
+    {
+        if (clean[s] < 0) {
+            clean[s] = 1;
+            const LR1Kernel &K = oldStates[s].kernel;
+            for (auto it = K.begin(); it != K.end() && clean[s]; ++it) {
+                if (prodToNew[it.key().prodId] < 0) {
+                    clean[s] = 0;
+                    break;
+                }
+                const QVector<int> &right = oldG.productions[it.key().prodId].right;
+                const int d = it.key().dotPos;
+                if (d < right.size() && dirty[right[d]]) clean[s] = 0;
+                for (int i = d + 1; i < right.size() && clean[s]; ++i) {
+                    if (firstChanged[right[i]]) clean[s] = 0;
+                }
+            }
+        }
+        return clean[s];
+    }
+
+    // 以下换算只用于可沿用状态及其后继：它们的产生式与向前看终结符在新文法中都存在
+    int symbol(int X) const { return symbolToNew[X]; }
+    const LR1Kernel &kernel(int s)
+    {
+        if (translated[s].isEmpty()) {
+            bool ok = true;
+            translated[s] = translate(oldStates[s].kernel, prodToNew, termToNew, newG.symbols.terminalCount, ok);
+        }
+        return translated[s];
+    }
+    QMap<int, TerminalSet> reductions(int s) const
+    {
+        if (identity) return oldStates[s].reductions;
+        QMap<int, TerminalSet> result;
+        const QMap<int, TerminalSet> &old = oldStates[s].reductions;
+        bool ok = true;
+        for (auto it = old.begin(); it != old.end(); ++it) {
+            result.insert(prodToNew[it.key()], translate(it.value(), termToNew, newG.symbols.terminalCount, ok));
+        }
+        return result;
+    }
+
+private:
+    const Grammar &oldG;
+    const Grammar &newG;
+    const QVector<LR1State> &oldStates;
+    const QHash<LR1Kernel, int> &oldIndex;
+
+    QVector<int> symbolToNew, termToNew, termToOld, prodToNew, prodToOld;
+    bool identity = false; // 产生式与终结符编号都没有变化，换算时直接共享旧数据
+    QVector<bool> firstChanged, dirty;
+    QVector<qint8> clean;           // -1 未判断
+    QVector<LR1Kernel> translated;  // 旧状态内核换算成新编号，按需求出
+
+    TerminalSet translate(const TerminalSet &set, const QVector<int> &termMap, int terminalCount, bool &ok) const
+    {
+        if (identity) return set;
+        TerminalSet result(terminalCount);
+        set.forEach([&](int t) {
+            if (termMap[t] < 0) ok = false;
+            else result.insert(termMap[t]);
+        });
+        return result;
+    }
+
+    LR1Kernel translate(const LR1Kernel &K, const QVector<int> &prodMap, const QVector<int> &termMap,
+                        int terminalCount, bool &ok) const
+    {
+        if (identity) return K;
+        LR1Kernel result;
+        for (auto it = K.begin(); it != K.end() && ok; ++it) {
+            const int p = prodMap[it.key().prodId];
+            if (p < 0) {
+                ok = false;
+                break;
+            }
+            result.insert(LR0Item{p, it.key().dotPos}, translate(it.value(), termMap, terminalCount, ok));
+        }
+        return result;
+    }
+};
+
+} // namespace
 
 void LRAnalyzer::buildLR1()
+{
+    buildLR1From(nullptr);
+}
+
+int LRAnalyzer::buildLR1Incremental(const LRAnalyzer &previous)
+{
+    return buildLR1From(&previous);
+}
+
+int LRAnalyzer::buildLR1From(const LRAnalyzer *previous)
 {
     buildAugmentedGrammar();
     lr1States.clear();
+    lr1KernelIndex.clear();
+    lazy.reset();
 
-    // 需要 FIRST 信息
-    if (augmentedGrammar.first.isEmpty()) {
-        augmentedGrammar.computeFirst();
-        augmentedGrammar.computeFollow();
+    QScopedPointer<LR1Reuse> reuse;
+    if (previous) {
+        reuse.reset(new LR1Reuse(previous->augmentedGrammar, augmentedGrammar,
+                                 previous->lr1States, previous->lr1KernelIndex));
     }
+    int reused = 0;
 
-    QSet<LR1Item> I0;
-    I0.insert(LR1Item{augmentedStartProdId, 0, augmentedGrammar.endMarker});
-    I0 = closureLR1(I0);
+    LR1Workspace space(augmentedGrammar);
+    LR1KernelStore store(space.wordCount());
 
-    lr1States.reserve(64);
-    LR1State s0;
-    s0.id = 0;
-    s0.items = I0;
-    lr1States.append(s0);
+    LR1Kernel K0;
+    K0[LR0Item{augmentedStartProdId, 0}].insert(Grammar::EndMarker);
 
+    // 增量构造时记录新旧状态的对应关系：沿用状态的后继若已建立，直接取其编号而不必查内核索引
+    QVector<int> oldOf;  // 新状态 -> 旧状态，-1 表示未知
+    QVector<int> newOf;  // 旧状态 -> 新状态
+    if (reuse) newOf.fill(-1, previous->lr1States.size());
+
+    // 内核先在 store 中查重，只有新状态才转换成 LR1State 的 QMap 形式
     QQueue<int> q;
-    q.enqueue(0);
+    auto stateFor = [&](const LR1KernelView &K, int oldState) {
+        const size_t hash = store.hashOf(K);
+        int existing = store.find(K, hash);
+        if (existing == -1) {
+            LR1State s;
+            s.id = lr1States.size();
+            s.kernel = space.toKernel(K);
+            store.add(K, hash, s.id);
+            lr1States.append(s);
+            if (reuse) oldOf.append(oldState);
+            existing = s.id;
+            q.enqueue(existing);
+        }
+        if (oldState >= 0) newOf[oldState] = existing;
+        return existing;
+    };
+
+    lr1States.reserve(64);
+    stateFor(space.view(K0), -1);
 
     while (!q.isEmpty()) {
         int si = q.dequeue();
-        QSet<LR1Item> I = lr1States[si].items;
+        int old = -1;
+        if (reuse) {
+            old = oldOf[si] >= 0 ? oldOf[si] : reuse->oldStateOf(lr1States[si].kernel);
+            if (old >= 0) newOf[old] = si;
+        }
 
-        QSet<QString> symbols;
-        for (const LR1Item &item : I) {
-            const Production &p = augmentedGrammar.productions[item.prodId];
-            if (item.dotPos < p.right.size()) {
-                symbols.insert(p.right[item.dotPos]);
+        if (old >= 0 && reuse->isClean(old)) {
+            ++reused;
+            lr1States[si].reductions = reuse->reductions(old);
+            // 按新符号编号的顺序登记后继，保证状态编号与完整构造相同
+            QMap<int, int> successors;
+            for (auto it = previous->lr1States[old].transitions.begin(); it != previous->lr1States[old].transitions.end(); ++it) {
+                successors.insert(reuse->symbol(it.key()), it.value());
+            }
+            for (auto it = successors.begin(); it != successors.end(); ++it) {
+                int target = newOf[it.value()];
+                if (target == -1) target = stateFor(space.view(reuse->kernel(it.value())), it.value());
+                lr1States[si].transitions[it.key()] = target;
             }
+            if (checkpoint(lr1States.size(), q.size())) {
+                lr1States.clear();
+                return 0;
+            }
+            continue;
         }
 
-        for (const QString &X : symbols) {
-            QSet<LR1Item> J = gotoLR1(I, X);
-            if (J.isEmpty()) continue;
+        space.close(store.entry(si));
+        lr1States[si].reductions = space.reductions();
+        space.forEachSuccessor([&](int X, const LR1KernelView &K) {
+            const int target = stateFor(K, -1);
+            lr1States[si].transitions.insert(X, target);
+        });
+        if (checkpoint(lr1States.size(), q.size())) {
+            lr1States.clear();
+            return 0;
+        }
+    }
 
-            int existing = -1;
-            for (int i = 0; i < lr1States.size(); ++i) {
-                if (lr1States[i].items == J) {
-                    existing = i;
-                    break;
+    for (const LR1State &s : lr1States) lr1KernelIndex.insert(s.kernel, s.id);
+    return reused;
+}
+
+namespace {
+
+struct LR1Work {
+    int state;
+    LR1Kernel kernel;
+};
+
+// 工作窃取队列：所有者从尾部取（刚产生的状态，内核数据还在缓存里），
+// 空闲线程从头部窃取（较早产生的状态，往往还会展开出更多后继）。
+// 单个状态的闭包与 goto 远比加锁耗时，每个队列一把互斥锁就够了
+class LR1WorkQueue
+{
+public:
+    void push(const LR1Work &work)
+    {
+        QMutexLocker lock(&mutex);
+        items.append(work);
+    }
+    bool pop(LR1Work &work)
+    {
+        QMutexLocker lock(&mutex);
+        if (items.isEmpty()) return false;
+        work = items.takeLast();
+        return true;
+    }
+    bool steal(LR1Work &work)
+    {
+        QMutexLocker lock(&mutex);
+        if (items.isEmpty()) return false;
+        work = items.takeFirst();
+        return true;
+    }
+
+private:
+    QMutex mutex;
+    QList<LR1Work> items;
+};
+
+// 并发的内核 -> 临时状态号索引：按内核哈希分片，每片一把锁和一个 LR1KernelStore，
+// 不同线程登记不同分片的内核时互不等待
+class LR1KernelShards
+{
+public:
+    explicit LR1KernelShards(int wordCount)
+    {
+        for (int i = 0; i < ShardCount; ++i) shards[i].store.reset(new LR1KernelStore(wordCount));
+    }
+
+    // 返回 K 的状态号；K 第一次出现时分配新号并置 inserted
+    int insert(const LR1KernelView &K, bool &inserted)
+    {
+        const size_t hash = shards[0].store->hashOf(K);
+        Shard &shard = shards[(hash >> 8) % ShardCount];
+        QMutexLocker lock(&shard.mutex);
+        int id = shard.store->find(K, hash);
+        inserted = id == -1;
+        if (!inserted) return id;
+        id = nextId.fetchAndAddRelaxed(1);
+        shard.store->add(K, hash, id);
+        return id;
+    }
+    int count() const { return nextId.loadRelaxed(); }
+
+private:
+    static constexpr int ShardCount = 64;
+    struct Shard {
+        QMutex mutex;
+        QScopedPointer<LR1KernelStore> store;
+    };
+    Shard shards[ShardCount];
+    QAtomicInt nextId{0};
+};
+
+
+} // namespace
+
+void LRAnalyzer::buildLR1Parallel(int threadCount)
+{
+    buildAugmentedGrammar();
+    lr1States.clear();
+    lr1KernelIndex.clear();
+    lazy.reset();
+    if (threadCount <= 0) threadCount = qMax(1, QThread::idealThreadCount());
+
+    LR1Workspace firstSpace(augmentedGrammar); // 0 号线程的工作区，其余线程各自建立
+    LR1KernelShards index(firstSpace.wordCount());
+    std::vector<LR1WorkQueue> queues(threadCount); // 队列含互斥锁，不可复制
+    QVector<QVector<LR1State>> explored(threadCount); // 每个线程只写自己的一份，id 为临时状态号
+    // 已登记但尚未处理完的状态数。先为后继加一再为当前状态减一，归零时所有状态都已展开
+    QAtomicInt pending(1);
+    // 找不到工作的线程在 workAvailable 上等待，而不是空转。pushes 每登记一个新状态加一，
+    // 等待前在 idleMutex 内先登记 idle、再确认 pushes 没变；登记方先加 pushes、再看 idle，
+    // 两边都是全序的原子操作，所以至少有一方能看到对方，不会漏掉唤醒。
+    // 取消不会唤醒等待者，所以等待设有超时
+    QMutex idleMutex;
+    QWaitCondition workAvailable;
+    QAtomicInt pushes(0);
+    QAtomicInt idle(0);
+
+    LR1Kernel K0;
+    K0[LR0Item{augmentedStartProdId, 0}].insert(Grammar::EndMarker);
+    bool inserted;
+    const int start = index.insert(firstSpace.view(K0), inserted);
+    queues[0].push(LR1Work{start, K0});
+
+    auto worker = [&](int self) {
+        QScopedPointer<LR1Workspace> ownSpace;
+        if (self > 0) ownSpace.reset(new LR1Workspace(augmentedGrammar));
+        LR1Workspace &space = self > 0 ? *ownSpace : firstSpace;
+        LR1Work work;
+        for (;;) {
+            if (cancelRequested()) return;
+            const int seen = pushes.loadAcquire();
+            bool found = queues[self].pop(work);
+            for (int k = 1; k < threadCount && !found; ++k) {
+                found = queues[(self + k) % threadCount].steal(work);
+            }
+            if (!found) {
+                if (pending.loadAcquire() == 0) return;
+                QMutexLocker locker(&idleMutex);
+                idle.ref();
+                if (pushes.fetchAndAddOrdered(0) == seen && pending.loadAcquire() != 0) {
+                    workAvailable.wait(&idleMutex, 20);
                 }
+                idle.deref();
+                continue;
             }
-            if (existing == -1) {
-                LR1State s;
-                s.id = lr1States.size();
-                s.items = J;
-                lr1States.append(s);
-                existing = s.id;
-                q.enqueue(existing);
+
+            LR1State result;
+            result.id = work.state;
+            result.kernel = work.kernel;
+            space.close(space.view(work.kernel));
+            result.reductions = space.reductions();
+            space.forEachSuccessor([&](int X, const LR1KernelView &K) {
+                bool isNew;
+                const int target = index.insert(K, isNew);
+                if (isNew) {
+                    pending.ref();
+                    queues[self].push(LR1Work{target, space.toKernel(K)});
+                    pushes.ref();
+                    if (idle.fetchAndAddOrdered(0) > 0) {
+                        QMutexLocker locker(&idleMutex);
+                        workAvailable.wakeOne();
+                    }
+                }
+                result.transitions.insert(X, target);
+            });
+            explored[self].append(result);
+            if (!pending.deref()) {
+                // 全部展开完毕，叫醒所有等待者退出
+                QMutexLocker locker(&idleMutex);
+                workAvailable.wakeAll();
+            }
+            if (self == 0 && progressHandler) progressHandler(index.count(), pending.loadRelaxed());
+        }
+    };
+
+    QVector<QThread *> threads;
+    for (int t = 1; t < threadCount; ++t) {
+        threads.append(QThread::create(worker, t));
+        threads.last()->start();
+    }
+    worker(0);
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    if (cancelRequested()) {
+        cancelled = true;
+        return;
+    }
+
+    QVector<LR1State> states(index.count());
+    for (const QVector<LR1State> &part : explored) {
+        for (const LR1State &s : part) states[s.id] = s;
+    }
+    renumberLR1States(states, start);
+}
+
+void LRAnalyzer::renumberLR1States(const QVector<LR1State> &states, int start)
+{
+    QVector<int> newId(states.size(), -1);
+    QVector<int> order;
+    newId[start] = 0;
+    order.append(start);
+    for (int i = 0; i < order.size(); ++i) {
+        for (int to : states[order[i]].transitions) {
+            if (newId[to] == -1) {
+                newId[to] = order.size();
+                order.append(to);
             }
-            lr1States[si].transitions[X] = existing;
         }
     }
+
+    lr1States.reserve(order.size());
+    for (int old : order) {
+        LR1State s;
+        s.id = newId[old];
+        s.kernel = states[old].kernel;
+        s.reductions = states[old].reductions;
+        for (auto it = states[old].transitions.begin(); it != states[old].transitions.end(); ++it) {
+            s.transitions.insert(it.key(), newId[it.value()]);
+        }
+        lr1KernelIndex.insert(s.kernel, s.id);
+        lr1States.append(s);
+    }
 }
 
-void LRAnalyzer::buildLR1Table()
+// Pager 弱相容：对同核心的两个内核 L、M 的任意两个项目 i != j，
+// 要么 L_i∩M_j 与 L_j∩M_i 都为空，要么 L_i∩L_j 或 M_i∩M_j 非空（冲突本来就存在）。
+// 满足时合并不会引入新的归约-归约冲突
+static bool weaklyCompatible(const LR1Kernel &a, const LR1Kernel &b)
 {
-    lr1Table.action.clear();
-    lr1Table.goTo.clear();
-    lr1Conflicts.clear();
+    const QList<TerminalSet> L = a.values();
+    const QList<TerminalSet> M = b.values();
+    for (int i = 0; i < L.size(); ++i) {
+        for (int j = i + 1; j < L.size(); ++j) {
+            if (!L[i].intersects(M[j]) && !L[j].intersects(M[i])) continue;
+            if (L[i].intersects(L[j]) || M[i].intersects(M[j])) continue;
+            return false;
+        }
+    }
+    return true;
+}
 
-    for (const LR1State &state : lr1States) {
-        int i = state.id;
-        // 移进和 goto
-        for (auto it = state.transitions.begin(); it != state.transitions.end(); ++it) {
-            QString X = it.key();
-            int j = it.value();
-            if (augmentedGrammar.terminals.contains(X)) {
-                ActionEntry entry;
-                entry.type = ActionEntry::Shift;
-                entry.target = j;
-                ActionEntry &cell = lr1Table.action[i][X];
-                if (cell.type != ActionEntry::None && !(cell.type == entry.type && cell.target == entry.target)) {
-                    ConflictInfo c;
-                    c.description = QObject::tr("LR(1) 冲突: 状态 %1, 符号 %2 发生移进冲突").arg(i).arg(X);
-                    lr1Conflicts.append(c);
-                } else {
-                    cell = entry;
+void LRAnalyzer::buildMinimalLR1()
+{
+    buildAugmentedGrammar();
+    lr1States.clear();
+    lr1KernelIndex.clear();
+    lazy.reset();
+
+    QVector<LR1Kernel> kernels;
+    QVector<QMap<int, int>> transitions;
+    QVector<QMap<int, TerminalSet>> reductions;
+    QHash<LR0Kernel, QVector<int>> statesByCore; // LR(0) 核心 -> 同核心的状态
+    QVector<bool> queued;
+    QQueue<int> q;
+
+    auto coreOf = [](const LR1Kernel &K) {
+        LR0Kernel core;
+        for (auto it = K.begin(); it != K.end(); ++it) core.insert(it.key());
+        return core;
+    };
+    auto addState = [&](const LR1Kernel &K) {
+        int id = kernels.size();
+        kernels.append(K);
+        transitions.append(QMap<int, int>());
+        reductions.append(QMap<int, TerminalSet>());
+        queued.append(true);
+        statesByCore[coreOf(K)].append(id);
+        q.enqueue(id);
+        return id;
+    };
+
+    LR1Workspace space(augmentedGrammar);
+    LR1Kernel K0;
+    K0[LR0Item{augmentedStartProdId, 0}].insert(Grammar::EndMarker);
+    addState(K0);
+
+    while (!q.isEmpty()) {
+        int si = q.dequeue();
+        queued[si] = false;
+        space.close(space.view(kernels[si]));
+        reductions[si] = space.reductions();
+
+        space.forEachSuccessor([&](int X, const LR1KernelView &view) {
+            const LR1Kernel K = space.toKernel(view);
+            const QVector<int> candidates = statesByCore.value(coreOf(K));
+
+            // 先找已经包含 K 的状态，其次找弱相容的状态并入；
+            // 并入使向前看集合变大时，该状态要重新求后继，把增量继续传下去
+            int target = -1;
+            for (int c : candidates) {
+                bool covers = true;
+                for (auto kt = K.begin(); kt != K.end() && covers; ++kt) {
+                    covers = kernels[c].value(kt.key()).containsAll(kt.value());
+                }
+                if (covers) {
+                    target = c;
+                    break;
                 }
-            } else if (augmentedGrammar.nonTerminals.contains(X)) {
-                lr1Table.goTo[i][X] = j;
             }
-        }
-
-        // 归约/接收
-        for (const LR1Item &item : state.items) {
-            const Production &p = augmentedGrammar.productions[item.prodId];
-            if (item.dotPos == p.right.size()) {
-                if (item.prodId == augmentedStartProdId && item.lookahead == augmentedGrammar.endMarker) {
-                    ActionEntry entry;
-                    entry.type = ActionEntry::Accept;
-                    ActionEntry &cell = lr1Table.action[i][augmentedGrammar.endMarker];
-                    if (cell.type != ActionEntry::None && cell.type != ActionEntry::Accept) {
-                        ConflictInfo c;
-                        c.description = QObject::tr("LR(1) 冲突: 状态 %1 上存在接受/其它动作冲突").arg(i);
-                        lr1Conflicts.append(c);
-                    } else {
-                        cell = entry;
+            if (target == -1) {
+                for (int c : candidates) {
+                    if (!weaklyCompatible(kernels[c], K)) continue;
+                    bool changed = false;
+                    for (auto kt = K.begin(); kt != K.end(); ++kt) {
+                        changed |= kernels[c][kt.key()].unite(kt.value());
                     }
-                } else {
-                    ActionEntry entry;
-                    entry.type = ActionEntry::Reduce;
-                    entry.target = item.prodId;
-                    const QString &a = item.lookahead;
-                    ActionEntry &cell = lr1Table.action[i][a];
-                    if (cell.type != ActionEntry::None && !(cell.type == entry.type && cell.target == entry.target)) {
-                        ConflictInfo c;
-                        c.description = QObject::tr("LR(1) 冲突: 状态 %1, 符号 %2 上产生归约冲突").arg(i).arg(a);
-                        lr1Conflicts.append(c);
-                    } else {
-                        cell = entry;
+                    if (changed && !queued[c]) {
+                        queued[c] = true;
+                        q.enqueue(c);
                     }
+                    target = c;
+                    break;
                 }
             }
+            if (target == -1) target = addState(K);
+            transitions[si][X] = target;
+        });
+        if (checkpoint(kernels.size(), q.size())) return;
+    }
+
+    // 重新求后继后，有的状态可能不再可达：从 0 号状态出发重新编号
+    QVector<LR1State> states(kernels.size());
+    for (int i = 0; i < kernels.size(); ++i) {
+        states[i].kernel = kernels[i];
+        states[i].transitions = transitions[i];
+        states[i].reductions = reductions[i];
+    }
+    renumberLR1States(states, 0);
+}
+
+int LRAnalyzer::lr1CoreCount() const
+{
+    QSet<LR0Kernel> cores;
+    for (const LR1State &s : lr1States) {
+        LR0Kernel core;
+        for (auto it = s.kernel.begin(); it != s.kernel.end(); ++it) core.insert(it.key());
+        cores.insert(core);
+    }
+    return cores.size();
+}
+
+struct LRAnalyzer::LazyLR1 {
+    Grammar grammar; // 增广文法的副本，工作区引用它，使副本与原分析器互不依赖
+    LR1Workspace space;
+    LR1KernelStore store; // 登记序号即状态号
+    QVector<bool> expanded;
+    QVector<QVector<ActionEntry>> actionRows; // 已展开状态的稠密 ACTION 行
+
+    explicit LazyLR1(const Grammar &g)
+        : grammar(g), space(grammar), store(space.wordCount())
+    {
+    }
+    LazyLR1(const LazyLR1 &other)
+        : grammar(other.grammar), space(grammar), store(other.store)
+        , expanded(other.expanded), actionRows(other.actionRows)
+    {
+    }
+};
+
+void LRAnalyzer::buildLR1Lazy()
+{
+    buildAugmentedGrammar();
+    lr1States.clear();
+    lr1KernelIndex.clear();
+    lr1Table.action.clear();
+    lr1Table.goTo.clear();
+    lr1Conflicts.clear();
+    lazy = std::make_shared<LazyLR1>(augmentedGrammar);
+
+    LR1State s;
+    s.id = 0;
+    s.kernel[LR0Item{augmentedStartProdId, 0}].insert(Grammar::EndMarker);
+    lazy->store.add(lazy->space.view(s.kernel), s.id);
+    lr1States.append(s);
+    lazy->expanded.append(false);
+    lazy->actionRows.append(QVector<ActionEntry>());
+}
+
+// 求状态的闭包，登记尚未出现的后继内核（只建内核，不展开），再填写该状态的 ACTION/GOTO 行
+void LRAnalyzer::expandLazy(int stateId)
+{
+    if (lazy.use_count() > 1) lazy = std::make_shared<LazyLR1>(*lazy);
+    LazyLR1 &lz = *lazy;
+
+    lz.space.close(lz.store.entry(stateId));
+    lr1States[stateId].reductions = lz.space.reductions();
+    lz.space.forEachSuccessor([&](int X, const LR1KernelView &K) {
+        const size_t hash = lz.store.hashOf(K);
+        int target = lz.store.find(K, hash);
+        if (target == -1) {
+            LR1State t;
+            t.id = lr1States.size();
+            t.kernel = lz.space.toKernel(K);
+            lz.store.add(K, hash, t.id);
+            lr1States.append(t);
+            target = t.id;
         }
+        lr1States[stateId].transitions.insert(X, target);
+    });
+    lz.expanded.resize(lr1States.size());
+    lz.actionRows.resize(lr1States.size());
+    lz.expanded[stateId] = true;
+
+    const LR1State &state = lr1States[stateId];
+    const QString mode = "LR(1)";
+    fillShiftsAndGotos(lr1Table, lr1Conflicts, mode, stateId, state.transitions);
+    fillReduceActions(lr1Table, lr1Conflicts, mode, stateId, state.reductions);
+    QVector<ActionEntry> &row = lz.actionRows[stateId];
+    row.resize(augmentedGrammar.symbols.terminalCount);
+    const QMap<int, ActionEntry> actions = lr1Table.action.value(stateId);
+    for (auto it = actions.begin(); it != actions.end(); ++it) row[it.key()] = it.value();
+}
+
+ActionEntry LRAnalyzer::lazyAction(int stateId, int terminal)
+{
+    if (!lazy->expanded[stateId]) expandLazy(stateId);
+    return lazy->actionRows[stateId][terminal];
+}
+
+int LRAnalyzer::lazyGoto(int stateId, int nonTerminal)
+{
+    if (!lazy->expanded[stateId]) expandLazy(stateId);
+    return lr1States[stateId].transitions.value(nonTerminal, -1);
+}
+
+int LRAnalyzer::lazyExpandedCount() const
+{
+    return lazy ? int(std::count(lazy->expanded.begin(), lazy->expanded.end(), true)) : 0;
+}
+
+void LRAnalyzer::buildLR1Table()
+{
+    lr1Table.action.clear();
+    lr1Table.goTo.clear();
+    lr1Conflicts.clear();
+
+    const QString mode = "LR(1)";
+    for (const LR1State &state : lr1States) {
+        // 移进和 goto
+        fillShiftsAndGotos(lr1Table, lr1Conflicts, mode, state.id, state.transitions);
+
+        // 归约/接收：完成项目在构造自动机时已经求出
+        fillReduceActions(lr1Table, lr1Conflicts, mode, state.id, state.reductions);
     }
 }
@@ -2,10 +2,13 @@
 #define LR_H
 
 #include "grammar.h"
+#include <QAtomicInt>
 #include <QMap>
 #include <QSet>
 #include <QVector>
 #include <QHash>
+#include <functional>
+#include <memory>
 
 struct LR0Item {
     int prodId;
@@ -19,24 +22,12 @@ struct LR0Item {
     }
 };
 
+// 状态只保存内核项目（S' -> ·S 以及点不在最左端的项目），
+// 闭包由 LRAnalyzer::lr0Closure() 按需计算
 struct LR0State {
     int id;
-    QSet<LR0Item> items;
-    QMap<QString,int> transitions; // symbol -> state id
-};
-
-struct LR1Item {
-    int prodId;
-    int dotPos;
-    QString lookahead;
-    bool operator<(const LR1Item &other) const {
-        if (prodId != other.prodId) return prodId < other.prodId;
-        if (dotPos != other.dotPos) return dotPos < other.dotPos;
-        return lookahead < other.lookahead;
-    }
-    bool operator==(const LR1Item &other) const {
-        return prodId == other.prodId && dotPos == other.dotPos && lookahead == other.lookahead;
-    }
+    QSet<LR0Item> kernel;
+    QMap<int,int> transitions; // symbol id -> state id
 };
 
 // 为 QSet<Q> 提供哈希支持（Qt6 要求自定义类型有 qHash）
@@ -45,26 +36,40 @@ inline uint qHash(const LR0Item &key, uint seed = 0) noexcept
     return qHash(qMakePair(key.prodId, key.dotPos), seed);
 }
 
-inline uint qHash(const LR1Item &key, uint seed = 0) noexcept
+// LR(1) 项目按 LR(0) 核心合并：核心项目（有序）-> 向前看终结符集合。
+// 同一核心带多个向前看符号时只占一项，闭包按集合整体求并传播
+using LR1Kernel = QMap<LR0Item, TerminalSet>;
+using LR1Closure = QHash<LR0Item, TerminalSet>;
+
+// 与 QMap 的 operator==（逐项比较核心与向前看集合）一致
+inline size_t qHash(const LR1Kernel &key, size_t seed = 0) noexcept
 {
-    // 简单组合三个字段
-    return qHash(qMakePair(qMakePair(key.prodId, key.dotPos), key.lookahead), seed);
+    for (auto it = key.begin(); it != key.end(); ++it) seed = qHashMulti(seed, it.key(), it.value());
+    return seed;
 }
 
 struct LR1State {
     int id;
-    QSet<LR1Item> items;
-    QMap<QString,int> transitions;
+    LR1Kernel kernel;              // 同 LR0State，闭包见 LRAnalyzer::lr1Closure()
+    QMap<int,int> transitions;
+    QMap<int, TerminalSet> reductions; // 闭包中的完成项目：产生式 -> 向前看集合，构造时顺带求出，填表直接使用
 };
 
+// 状态查重使用内核（goto 得到的、尚未求闭包的项目集）作为键。
+// QHash 对 QSet 的哈希是逐项哈希后交换律组合，与项目的插入顺序无关，
+// 因此每次查找的期望代价是 O(内核大小)，而不是逐个状态比较整个闭包。
+// 索引与 LR0State::kernel/LR1State::kernel 隐式共享同一份数据。
+using LR0Kernel = QSet<LR0Item>;
+
+// Error 是由 %nonassoc 裁决出的出错格，与空格不同，之后写入的动作不会覆盖它，默认归约也不会用到它
 struct ActionEntry {
-    enum Type { None, Shift, Reduce, Accept } type = None;
+    enum Type { None, Shift, Reduce, Accept, Error } type = None;
     int target = -1; // 对于 Shift 是状态号；Reduce 是产生式 id
 };
 
 struct LRTable {
-    QMap<int, QMap<QString, ActionEntry>> action; // state -> terminal -> action
-    QMap<int, QMap<QString, int>> goTo;           // state -> nonterminal -> state
+    QMap<int, QMap<int, ActionEntry>> action; // state -> terminal id -> action
+    QMap<int, QMap<int, int>> goTo;           // state -> nonterminal id -> state
 };
 
 struct ConflictInfo {
@@ -81,20 +86,55 @@ public:
     void buildSLRTable();
     bool isSLR1() const { return slrConflicts.isEmpty(); }
     const QVector<LR0State>& getLR0States() const { return lr0States; }
+    QSet<LR0Item> lr0Closure(int stateId) const { return closureLR0(lr0States[stateId].kernel); }
     const QList<ConflictInfo>& getSLRConflicts() const { return slrConflicts; }
     const LRTable& getSLRTable() const { return slrTable; }
 
+    // LALR(1)：在 LR(0) 自动机上用 DeRemer–Pennello 关系计算向前看集合（需先 buildLR0）
+    void buildLALRTable();
+    bool isLALR1() const { return lalrConflicts.isEmpty(); }
+    TerminalSet lalrLookahead(int stateId, int prodId) const; // LR(0) 状态中完成项目的向前看集合
+    const QList<ConflictInfo>& getLALRConflicts() const { return lalrConflicts; }
+    const LRTable& getLALRTable() const { return lalrTable; }
+
     // LR(1)
     void buildLR1();
+    // 多线程构造：结果（包括状态编号）与 buildLR1() 相同，与线程数和调度顺序无关。
+    // threadCount <= 0 时使用 QThread::idealThreadCount()
+    void buildLR1Parallel(int threadCount = 0);
+    // 增量构造：previous 持有修改前文法的规范 LR(1) 自动机。闭包不涉及被修改的产生式、
+    // 也不涉及 FIRST/可空性变化的符号的旧状态，直接沿用其后继与完成项目，其余状态重新求闭包。
+    // 结果与 buildLR1() 相同；返回沿用的状态数
+    int buildLR1Incremental(const LRAnalyzer &previous);
+    // 最小 LR(1)：按 Pager 弱相容条件合并同核心状态，结果同样存入 LR(1) 状态，
+    // 随后用 buildLR1Table() 填表。状态数接近 LALR(1)，但不会引入 LR(1) 没有的冲突
+    void buildMinimalLR1();
     void buildLR1Table();
+    // 惰性 LR(1)：只建立初始状态 0。其余状态由分析驱动经 lazyAction()/lazyGoto() 第一次查询时
+    // 才求闭包、登记后继内核并填写该状态的 ACTION/GOTO 行，结果留在 LR(1) 状态与分析表中供之后复用。
+    // 已展开状态的内容与 buildLR1() 相同，但编号按首次到达的顺序分配；未展开的状态只有内核
+    void buildLR1Lazy();
+    ActionEntry lazyAction(int stateId, int terminal);
+    int lazyGoto(int stateId, int nonTerminal); // 无转移为 -1
+    int lazyExpandedCount() const;
+    int lr1CoreCount() const; // LR(1) 状态中不同 LR(0) 核心的个数，即 LALR(1) 状态数
     const QVector<LR1State>& getLR1States() const { return lr1States; }
+    LR1Closure lr1Closure(int stateId) const { return closureLR1(lr1States[stateId].kernel); }
     const QList<ConflictInfo>& getLR1Conflicts() const { return lr1Conflicts; }
     const LRTable& getLR1ParseTable() const { return lr1Table; }
 
+    // 供后台线程构造使用：自动机构造（LR(0)、各种 LR(1)）每展开一个状态后调用
+    // progress(已发现的状态数, 待展开的状态数)，多线程构造时只在发起构造的线程上调用。
+    // *cancel 非零时构造在展开下一个状态前停止，清空未完成的状态，wasCancelled() 返回 true
+    void setBuildMonitor(std::function<void(int, int)> progress, const QAtomicInt *cancel);
+    bool wasCancelled() const { return cancelled; }
+
     // 提供给界面，用于打印项目集（注意 LR(0)/LR(1) 的产生式编号基于增广文法）
     const Grammar& getAugmentedGrammar() const { return augmentedGrammar; }
 
 private:
+    friend class TableCache; // 读写磁盘缓存时直接存取 LR(1) 状态与分析表
+
     const Grammar &grammar;
 
     // 增广文法信息
@@ -103,22 +143,56 @@ private:
 
     // LR(0)
     QVector<LR0State> lr0States;
+    QHash<LR0Kernel, int> lr0KernelIndex; // 内核 -> 状态号
     LRTable slrTable;
     QList<ConflictInfo> slrConflicts;
 
+    // LALR(1)
+    QHash<QPair<int, int>, TerminalSet> lalrLookaheads; // (状态, 产生式) -> 向前看集合
+    LRTable lalrTable;
+    QList<ConflictInfo> lalrConflicts;
+
     // LR(1)
     QVector<LR1State> lr1States;
+    QHash<LR1Kernel, int> lr1KernelIndex; // 内核 -> 状态号
     LRTable lr1Table;
     QList<ConflictInfo> lr1Conflicts;
 
+    std::function<void(int, int)> progressHandler;
+    const QAtomicInt *cancelToken = nullptr;
+    bool cancelled = false;
+    bool cancelRequested() const { return cancelToken && cancelToken->loadRelaxed(); }
+    bool checkpoint(int discovered, int queued); // 报告进度，返回是否应当停止
+
+    // 惰性 LR(1) 的构造工作区；复制 LRAnalyzer 时共享，展开状态前若仍被共享则先复制一份（写时复制）
+    struct LazyLR1;
+    std::shared_ptr<LazyLR1> lazy;
+    void expandLazy(int stateId);
+
     // 工具函数
     QSet<LR0Item> closureLR0(const QSet<LR0Item> &I) const;
-    QSet<LR0Item> gotoLR0(const QSet<LR0Item> &I, const QString &X) const;
+    QSet<LR0Item> gotoLR0(const QSet<LR0Item> &I, int X) const;
+    // 一次扫描求出 I 对所有符号的 goto 内核（未求闭包）
+    QMap<int, LR0Kernel> gotoKernelsLR0(const QSet<LR0Item> &I) const;
 
-    QSet<LR1Item> closureLR1(const QSet<LR1Item> &I) const;
-    QSet<LR1Item> gotoLR1(const QSet<LR1Item> &I, const QString &X) const;
+    // 向前看集合增大的项目重新入队，把增量整体传给它产生的闭包项目
+    LR1Closure closureLR1(const LR1Kernel &K) const;
+    int buildLR1From(const LRAnalyzer *previous); // previous 为空时即 buildLR1()
+    // 由 states（下标为临时状态号）从 start 出发按符号顺序广度优先编号，写入 lr1States；
+    // 编号顺序与 buildLR1() 的工作队列顺序一致
+    void renumberLR1States(const QVector<LR1State> &states, int start);
 
     void buildAugmentedGrammar();
+
+    // 填表：格子冲突时记录 ConflictInfo 并保留先写入的动作
+    void setAction(LRTable &table, QList<ConflictInfo> &conflicts, const QString &mode,
+                   int state, int term, const ActionEntry &entry) const;
+    void fillShiftsAndGotos(LRTable &table, QList<ConflictInfo> &conflicts, const QString &mode,
+                            int state, const QMap<int, int> &transitions) const;
+    // reductions 为该状态全部完成项目（产生式 -> 向前看集合），须在 fillShiftsAndGotos 之后调用；
+    // 与移进同格的归约在这里按优先级裁决
+    void fillReduceActions(LRTable &table, QList<ConflictInfo> &conflicts, const QString &mode,
+                           int state, const QMap<int, TerminalSet> &reductions) const;
 };
 
 #endif // LR_H
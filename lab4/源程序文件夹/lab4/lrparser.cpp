@@ -0,0 +1,123 @@
+#include "lrparser.h"
+
+#include <QObject>
+
+LRParser::LRParser(const CompiledTable &table)
+    : table(table)
+    , stateStack(256)
+{
+}
+
+bool LRParser::tokenize(const Grammar &g, const QString &sentence, QVector<int> &tokens, QString &errorMsg)
+{
+    tokens.clear();
+    const QStringList names = Grammar::splitSymbols(sentence);
+    tokens.reserve(names.size() + 1);
+    for (const QString &name : names) {
+        int id = g.symbols.id(name);
+        if (!g.isTerminal(id) || id == Grammar::EndMarker) {
+            errorMsg = QObject::tr("句子中含有不是终结符的符号: %1").arg(name);
+            return false;
+        }
+        tokens.append(id);
+    }
+    tokens.append(Grammar::EndMarker);
+    return true;
+}
+
+bool LRParser::parse(const QVector<int> &tokens)
+{
+    traceSteps.clear();
+    symbolStack.clear();
+    errorPos = -1;
+
+    int *stack = stateStack.data();
+    int capacity = stateStack.size();
+    int top = 0;
+    stack[0] = 0;
+    int pos = 0;
+
+    // 栈满时加倍；+1 为空产生式归约后压入 goto 状态留出位置
+    auto ensureRoom = [&]() {
+        if (top + 1 >= capacity) {
+            stateStack.resize(capacity * 2);
+            stack = stateStack.data();
+            capacity = stateStack.size();
+        }
+    };
+
+    for (;;) {
+        const int a = tokens[pos];
+        const int act = table.action(stack[top], a);
+
+        if (trace) {
+            ParseStep step;
+            step.states = QVector<int>(stack, stack + top + 1);
+            step.symbols = symbolStack;
+            step.inputPos = pos;
+            step.action = act;
+            traceSteps.append(step);
+        }
+
+        if (CompiledTable::isShift(act)) {
+            ensureRoom();
+            stack[++top] = CompiledTable::shiftTarget(act);
+            if (trace) symbolStack.append(a);
+            ++pos;
+        } else if (CompiledTable::isReduce(act)) {
+            const int prodId = CompiledTable::reduceProduction(act);
+            const int len = table.productionLength(prodId);
+            const int left = table.productionLeft(prodId);
+            top -= len;
+            ensureRoom();
+            stack[top + 1] = table.goTo(stack[top], left);
+            ++top;
+            if (trace) {
+                symbolStack.resize(symbolStack.size() - len);
+                symbolStack.append(left);
+            }
+        } else if (act == CompiledTable::Accept) {
+            return true;
+        } else {
+            errorPos = pos;
+            return false;
+        }
+    }
+}
+
+LazyLRParser::LazyLRParser(LRAnalyzer &analyzer)
+    : analyzer(analyzer)
+{
+    const Grammar &g = analyzer.getAugmentedGrammar();
+    prodLength.resize(g.productions.size());
+    prodLeft.resize(g.productions.size());
+    for (const Production &p : g.productions) {
+        prodLength[p.id] = p.right.size();
+        prodLeft[p.id] = p.left;
+    }
+}
+
+bool LazyLRParser::parse(const QVector<int> &tokens)
+{
+    errorPos = -1;
+    stateStack.clear();
+    stateStack.append(0);
+    int pos = 0;
+
+    for (;;) {
+        const int a = tokens[pos];
+        const ActionEntry act = analyzer.lazyAction(stateStack.last(), a);
+        if (act.type == ActionEntry::Shift) {
+            stateStack.append(act.target);
+            ++pos;
+        } else if (act.type == ActionEntry::Reduce) {
+            stateStack.resize(stateStack.size() - prodLength[act.target]);
+            stateStack.append(analyzer.lazyGoto(stateStack.last(), prodLeft[act.target]));
+        } else if (act.type == ActionEntry::Accept) {
+            return true;
+        } else {
+            errorPos = pos;
+            return false;
+        }
+    }
+}
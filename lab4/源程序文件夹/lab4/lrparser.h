@@ -0,0 +1,67 @@
+#ifndef LRPARSER_H
+#define LRPARSER_H
+
+#include "compiledtable.h"
+#include "grammar.h"
+#include "lr.h"
+#include <QString>
+#include <QVector>
+
+// 分析过程中的一步（仅在开启跟踪时记录）
+struct ParseStep {
+    QVector<int> states;  // 状态栈
+    QVector<int> symbols; // 符号栈（符号编号）
+    int inputPos;         // 当前输入位置
+    int action;           // 本步执行的动作，编码见 CompiledTable
+};
+
+// 基于 CompiledTable 的移进-归约分析驱动。
+// 状态栈预先分配并在多次分析之间复用，不跟踪时每一步只有查表和栈操作，没有堆分配；
+// 适合用同一张表连续分析大量句子。
+class LRParser
+{
+public:
+    explicit LRParser(const CompiledTable &table);
+
+    void setTrace(bool on) { trace = on; }
+
+    // tokens 为终结符编号序列，须以 Grammar::EndMarker 结尾
+    bool parse(const QVector<int> &tokens);
+
+    int errorPosition() const { return errorPos; } // 出错时的输入位置，接受时为 -1
+    const QVector<ParseStep>& steps() const { return traceSteps; }
+
+    // 按文法的分词规则把句子转换为终结符编号序列（末尾加 #）；遇到未知符号返回 false
+    static bool tokenize(const Grammar &g, const QString &sentence, QVector<int> &tokens, QString &errorMsg);
+
+private:
+    const CompiledTable &table;
+    QVector<int> stateStack;
+    QVector<int> symbolStack; // 只在跟踪时维护
+    bool trace = false;
+    QVector<ParseStep> traceSteps;
+    int errorPos = -1;
+};
+
+// 惰性 LR(1) 分析驱动：不经过打包表，直接向 LRAnalyzer 查询 ACTION 与 GOTO，
+// 状态在第一次用到时才构造（见 LRAnalyzer::buildLR1Lazy）。同一 analyzer 上连续分析的句子共享已构造的状态，
+// 因此启动几乎没有代价，构造量只随实际走到的状态增长
+class LazyLRParser
+{
+public:
+    // analyzer 须已调用 buildLR1Lazy()
+    explicit LazyLRParser(LRAnalyzer &analyzer);
+
+    // tokens 为终结符编号序列，须以 Grammar::EndMarker 结尾
+    bool parse(const QVector<int> &tokens);
+
+    int errorPosition() const { return errorPos; } // 出错时的输入位置，接受时为 -1
+
+private:
+    LRAnalyzer &analyzer;
+    QVector<int> prodLength, prodLeft;
+    QVector<int> stateStack;
+    int errorPos = -1;
+};
+
+#endif // LRPARSER_H
@@ -1,12 +1,22 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QFile>
 #include <QMessageBox>
 #include <QTextStream>
+#include <QTimer>
 
+#include "buildtask.h"
+#include "codegen.h"
 #include "lr.h"
+#include "lrparser.h"
+#include "tablecache.h"
+#include "tablemodels.h"
+
+#include <algorithm>
 
 static QString lr0ItemToString(const Grammar &g, const LR0Item &item)
 {
@@ -14,20 +24,40 @@ static QString lr0ItemToString(const Grammar &g, const LR0Item &item)
     QStringList rhs;
     for (int i = 0; i <= p.right.size(); ++i) {
         if (i == item.dotPos) rhs << "·";
-        if (i < p.right.size()) rhs << p.right[i];
+        if (i < p.right.size()) rhs << g.symbolName(p.right[i]);
     }
-    return QString("%1 -> %2").arg(p.left, rhs.join(" "));
+    return QString("%1 -> %2").arg(g.symbolName(p.left), rhs.join(" "));
 }
 
-static QString lr1ItemToString(const Grammar &g, const LR1Item &item)
+// 同核心的 LR(1) 项目合并显示：[A -> α·β, a/b/c]
+static QString lr1ItemToString(const Grammar &g, const LR0Item &core, const TerminalSet &lookaheads)
 {
-    const Production &p = g.productions[item.prodId];
+    const Production &p = g.productions[core.prodId];
     QStringList rhs;
     for (int i = 0; i <= p.right.size(); ++i) {
-        if (i == item.dotPos) rhs << "·";
-        if (i < p.right.size()) rhs << p.right[i];
+        if (i == core.dotPos) rhs << "·";
+        if (i < p.right.size()) rhs << g.symbolName(p.right[i]);
     }
-    return QString("[%1 -> %2, %3]").arg(p.left, rhs.join(" "), item.lookahead);
+    QStringList names;
+    lookaheads.forEach([&](int a) { names << g.symbolName(a); });
+    return QString("[%1 -> %2, %3]").arg(g.symbolName(p.left), rhs.join(" "), names.join("/"));
+}
+
+// 把终结符编号集合转换为名字列表（界面显示用），nullable 时追加 @
+static QString symbolSetToString(const Grammar &g, const TerminalSet &set, bool withEpsilon)
+{
+    QStringList names;
+    set.forEach([&](int id) { names << g.symbolName(id); });
+    if (withEpsilon) names << g.epsilon;
+    return names.join(", ");
+}
+
+// 替换视图的模型，旧模型随之释放
+static void setTableModel(QTableView *view, QAbstractItemModel *model)
+{
+    QAbstractItemModel *old = view->model();
+    view->setModel(model);
+    delete old;
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -36,10 +66,19 @@ MainWindow::MainWindow(QWidget *parent)
     , grammar(new Grammar)
 {
     ui->setupUi(this);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setSingleShot(true);
+    refreshTimer->setInterval(300);
+    connect(refreshTimer, &QTimer::timeout, this, &MainWindow::refreshAnalysis);
+    connect(ui->grammarEdit, &QPlainTextEdit::textChanged, this, [this]() {
+        if (ui->actionIncrementalMode->isChecked() && lastBuildAction) refreshTimer->start();
+    });
 }
 
 MainWindow::~MainWindow()
 {
+    delete lr1Task;
     delete grammar;
     delete ui;
 }
@@ -58,6 +97,7 @@ void MainWindow::on_actionOpenGrammar_triggered()
     QString text = in.readAll();
     f.close();
     ui->grammarEdit->setPlainText(text);
+    grammarFileName = fileName;
 }
 
 void MainWindow::on_actionSaveGrammar_triggered()
@@ -73,18 +113,33 @@ void MainWindow::on_actionSaveGrammar_triggered()
     QTextStream out(&f);
     out << ui->grammarEdit->toPlainText();
     f.close();
+    grammarFileName = fileName;
 }
 
-void MainWindow::on_actionComputeFirstFollow_triggered()
+void MainWindow::on_actionExportParser_triggered()
 {
-    QString text = ui->grammarEdit->toPlainText();
-    QString error;
-    if (!grammar->parseFromText(text, error)) {
-        QMessageBox::warning(this, tr("文法错误"), error);
+    if (!checkParseTable()) return;
+
+    QString fileName = QFileDialog::getSaveFileName(this, tr("导出 C++ 分析器"), QString(), tr("C++ Header (*.h *.hpp);;All Files (*.*)"));
+    if (fileName.isEmpty()) return;
+
+    // 以文件名作为生成代码的命名空间
+    CodeGenerator generator(parseTable, parseGrammar, QFileInfo(fileName).completeBaseName());
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("错误"), tr("无法写入文件: %1").arg(fileName));
         return;
     }
-    grammar->computeFirst();
-    grammar->computeFollow();
+    QTextStream out(&f);
+    out << generator.tableParserHeader();
+    f.close();
+    statusBar()->showMessage(tr("已导出 %1 分析器：%2").arg(parseTableName, fileName));
+}
+
+void MainWindow::on_actionComputeFirstFollow_triggered()
+{
+    if (!prepareGrammar()) return;
+    lastBuildAction = ui->actionComputeFirstFollow;
 
     // 填充 FIRST 表
     ui->tableFirst->clear();
@@ -92,13 +147,12 @@ void MainWindow::on_actionComputeFirstFollow_triggered()
     firstHeaders << tr("非终结符") << tr("FIRST 集合");
     ui->tableFirst->setColumnCount(2);
     ui->tableFirst->setHorizontalHeaderLabels(firstHeaders);
-    ui->tableFirst->setRowCount(grammar->nonTerminals.size());
+    ui->tableFirst->setRowCount(grammar->symbols.nonTerminalCount());
 
     int row = 0;
-    for (const QString &nt : grammar->nonTerminals) {
-        ui->tableFirst->setItem(row, 0, new QTableWidgetItem(nt));
-        QStringList elems = grammar->first[nt].values();
-        ui->tableFirst->setItem(row, 1, new QTableWidgetItem(elems.join(", ")));
+    for (int nt = grammar->symbols.terminalCount; nt < grammar->symbols.size(); ++nt) {
+        ui->tableFirst->setItem(row, 0, new QTableWidgetItem(grammar->symbolName(nt)));
+        ui->tableFirst->setItem(row, 1, new QTableWidgetItem(symbolSetToString(*grammar, grammar->first[nt], grammar->nullable[nt])));
         ++row;
     }
 
@@ -108,29 +162,24 @@ void MainWindow::on_actionComputeFirstFollow_triggered()
     followHeaders << tr("非终结符") << tr("FOLLOW 集合");
     ui->tableFollow->setColumnCount(2);
     ui->tableFollow->setHorizontalHeaderLabels(followHeaders);
-    ui->tableFollow->setRowCount(grammar->nonTerminals.size());
+    ui->tableFollow->setRowCount(grammar->symbols.nonTerminalCount());
 
     row = 0;
-    for (const QString &nt : grammar->nonTerminals) {
-        ui->tableFollow->setItem(row, 0, new QTableWidgetItem(nt));
-        QStringList elems = grammar->follow[nt].values();
-        ui->tableFollow->setItem(row, 1, new QTableWidgetItem(elems.join(", ")));
+    for (int nt = grammar->symbols.terminalCount; nt < grammar->symbols.size(); ++nt) {
+        ui->tableFollow->setItem(row, 0, new QTableWidgetItem(grammar->symbolName(nt)));
+        ui->tableFollow->setItem(row, 1, new QTableWidgetItem(symbolSetToString(*grammar, grammar->follow[nt], false)));
         ++row;
     }
 }
 
 void MainWindow::on_actionBuildLR0SLR_triggered()
 {
-    QString text = ui->grammarEdit->toPlainText();
-    QString error;
-    if (!grammar->parseFromText(text, error)) {
-        QMessageBox::warning(this, tr("文法错误"), error);
-        return;
-    }
-    grammar->computeFirst();
-    grammar->computeFollow();
+    if (!prepareGrammar()) return;
+    lastBuildAction = ui->actionBuildLR0SLR;
 
-    LRAnalyzer analyzer(*grammar);
+    // 分析器由表格模型共享，单元格文本在显示时才生成
+    QSharedPointer<LRAnalyzer> shared(new LRAnalyzer(*grammar));
+    LRAnalyzer &analyzer = *shared;
     analyzer.buildLR0();
     analyzer.buildSLRTable();
 
@@ -138,42 +187,14 @@ void MainWindow::on_actionBuildLR0SLR_triggered()
     const Grammar &augG = analyzer.getAugmentedGrammar();
 
     // 状态项目集表
-    ui->tableLR0States->clear();
-    ui->tableLR0States->setColumnCount(2);
-    ui->tableLR0States->setHorizontalHeaderLabels(QStringList() << tr("状态") << tr("项目集"));
-    ui->tableLR0States->setRowCount(states.size());
-
-    for (int i = 0; i < states.size(); ++i) {
-        const LR0State &s = states[i];
-        ui->tableLR0States->setItem(i, 0, new QTableWidgetItem(QString::number(s.id)));
+    setTableModel(ui->tableLR0States, new LRStateModel(states.size(), [shared](int stateId) {
         QStringList itemStrs;
-        for (const LR0Item &it : s.items) {
-            itemStrs << lr0ItemToString(augG, it);
-        }
-        ui->tableLR0States->setItem(i, 1, new QTableWidgetItem(itemStrs.join("\n")));
-    }
-    ui->tableLR0States->resizeRowsToContents();
+        for (const LR0Item &it : shared->lr0Closure(stateId)) itemStrs << lr0ItemToString(shared->getAugmentedGrammar(), it);
+        return itemStrs.join("\n");
+    }, ui->tableLR0States));
 
     // LR(0) 转移表（点与边数据）
-    ui->tableLR0Trans->clear();
-    ui->tableLR0Trans->setColumnCount(3);
-    ui->tableLR0Trans->setHorizontalHeaderLabels(QStringList() << tr("From") << tr("Symbol") << tr("To"));
-
-    int edgeRowCount = 0;
-    for (const LR0State &s : states) {
-        edgeRowCount += s.transitions.size();
-    }
-    ui->tableLR0Trans->setRowCount(edgeRowCount);
-
-    int r = 0;
-    for (const LR0State &s : states) {
-        for (auto it = s.transitions.begin(); it != s.transitions.end(); ++it) {
-            ui->tableLR0Trans->setItem(r, 0, new QTableWidgetItem(QString::number(s.id)));
-            ui->tableLR0Trans->setItem(r, 1, new QTableWidgetItem(it.key()));
-            ui->tableLR0Trans->setItem(r, 2, new QTableWidgetItem(QString::number(it.value())));
-            ++r;
-        }
-    }
+    setTableModel(ui->tableLR0Trans, TransitionModel::fromStates(augG, states, ui->tableLR0Trans));
 
     // SLR(1) 判断结果
     const QList<ConflictInfo> &conflicts = analyzer.getSLRConflicts();
@@ -189,220 +210,425 @@ void MainWindow::on_actionBuildLR0SLR_triggered()
         ui->plainTextSLRConflicts->setPlainText(lines.join("\n"));
     }
 
-    // 构造 SLR 分析表，格式参考示例：状态 / 动作 / 规则 / 输入 / Goto
+    // SLR 分析表，格式参考示例：状态 / 动作 / 规则 / 输入 / Goto
     const LRTable &slrTable = analyzer.getSLRTable();
-    const Grammar &slrG = analyzer.getAugmentedGrammar();
-
-    // 终结符（输入列）
-    QSet<QString> termSet = slrG.terminals;
-    termSet.insert(slrG.endMarker);
-    QStringList termList = termSet.values();
-    termList.sort();
-
-    // 非终结符（Goto 列）
-    QStringList nonTermList = slrG.nonTerminals.values();
-    nonTermList.removeAll(slrG.startSymbol); // 可以按需移除增广开始符
-    nonTermList.sort();
-
-    int colCount = 3 + termList.size() + nonTermList.size();
-    ui->tableSLR->clear();
-    ui->tableSLR->setColumnCount(colCount);
-
-    QStringList headers;
-    headers << tr("状态") << tr("动作") << tr("规则");
-    for (const QString &t : termList) headers << t;
-    for (const QString &nt : nonTermList) headers << nt;
-    ui->tableSLR->setHorizontalHeaderLabels(headers);
-
-    ui->tableSLR->setRowCount(states.size());
-    for (int i = 0; i < states.size(); ++i) {
-        int stateId = states[i].id;
-        ui->tableSLR->setItem(i, 0, new QTableWidgetItem(QString::number(stateId)));
-
-        // 统计该状态的动作类型和规约规则（如果有）
-        QString actionType;
-        QString ruleText;
-
-        auto aRowIt = slrTable.action.find(stateId);
-        if (aRowIt != slrTable.action.end()) {
-            const auto &rowMap = aRowIt.value();
-            for (auto it = rowMap.begin(); it != rowMap.end(); ++it) {
-                const ActionEntry &ae = it.value();
-                if (ae.type == ActionEntry::Shift) {
-                    if (!actionType.contains(tr("移进"))) actionType += tr("移进 ");
-                } else if (ae.type == ActionEntry::Reduce) {
-                    if (!actionType.contains(tr("归约"))) actionType += tr("归约 ");
-                    const Production &p = slrG.productions[ae.target];
-                    QString rhs = p.right.isEmpty() ? slrG.epsilon : p.right.join(" ");
-                    QString oneRule = QString("%1 → %2").arg(p.left, rhs);
-                    if (!ruleText.contains(oneRule)) {
-                        if (!ruleText.isEmpty()) ruleText += " ; ";
-                        ruleText += oneRule;
-                    }
-                } else if (ae.type == ActionEntry::Accept) {
-                    if (!actionType.contains(tr("接收"))) actionType += tr("接收 ");
-                }
-            }
+    setTableModel(ui->tableSLR, new ActionGotoModel(augG, slrTable, states.size(), ActionGotoModel::SLR, ui->tableSLR));
+
+    setParseTable(analyzer, slrTable, states.size(), "SLR(1)", GLRTable::SLR1, !conflicts.isEmpty());
+}
+
+// LR(1) 状态项目集、转移表（点与边数据）与分析表，规范与最小 LR(1) 共用
+void MainWindow::showLR1Automaton(const QSharedPointer<LRAnalyzer> &shared)
+{
+    const QVector<LR1State> &states = shared->getLR1States();
+    const Grammar &augG = shared->getAugmentedGrammar();
+
+    setTableModel(ui->tableLR1States, new LRStateModel(states.size(), [shared](int stateId) {
+        QStringList itemStrs;
+        const LR1Closure items = shared->lr1Closure(stateId);
+        for (auto it = items.begin(); it != items.end(); ++it) {
+            itemStrs << lr1ItemToString(shared->getAugmentedGrammar(), it.key(), it.value());
         }
+        return itemStrs.join("\n");
+    }, ui->tableLR1States));
+    setTableModel(ui->tableLR1Trans, TransitionModel::fromStates(augG, states, ui->tableLR1Trans));
+    setTableModel(ui->tableLR1Parse, new ActionGotoModel(augG, shared->getLR1ParseTable(), states.size(),
+                                                         ActionGotoModel::Plain, ui->tableLR1Parse));
+}
+
+void MainWindow::on_actionBuildLR1Table_triggered()
+{
+    lastBuildAction = ui->actionBuildLR1Table;
+    startLR1Build(false);
+}
+
+void MainWindow::on_actionBuildMinimalLR1Table_triggered()
+{
+    lastBuildAction = ui->actionBuildMinimalLR1Table;
+    startLR1Build(true);
+}
+
+// LR(1) 构造在后台线程中进行，界面保持响应。文法来自文件时先尝试读取文件旁的缓存，
+// 未命中则构造并写回缓存（编辑触发的刷新不写）；增量模式下规范 LR(1) 在上一次的自动机上增量构造。
+// 上一次构造尚未结束时先取消它，释放时等待其线程在当前状态处停下
+void MainWindow::startLR1Build(bool minimal)
+{
+    if (lr1Task) {
+        lr1Task->disconnect(this);
+        lr1Task->cancel();
+        lr1Task->deleteLater();
+    }
+
+    LR1BuildTask::Options options;
+    options.grammarText = ui->grammarEdit->toPlainText();
+    options.minimal = minimal;
+    options.incremental = ui->actionIncrementalMode->isChecked();
+    options.previousGrammar = previousGrammar;
+    options.previous = previousLR1;
+    options.grammarFile = grammarFileName;
+    options.writeCache = !liveRefresh;
+
+    lr1Task = new LR1BuildTask(options, this);
+    lr1TaskLive = liveRefresh;
+    lr1Timer.start();
+    connect(lr1Task, &LR1BuildTask::progress, this, &MainWindow::lr1BuildProgress);
+    connect(lr1Task, &LR1BuildTask::finished, this, &MainWindow::lr1BuildFinished);
+    ui->actionCancelBuild->setEnabled(true);
+    statusBar()->showMessage(tr("%1 构造中...").arg(minimal ? tr("最小 LR(1)") : "LR(1)"));
+    lr1Task->start();
+}
 
-        ui->tableSLR->setItem(i, 1, new QTableWidgetItem(actionType.trimmed()));
-        ui->tableSLR->setItem(i, 2, new QTableWidgetItem(ruleText));
-
-        // 填输入列
-        for (int ti = 0; ti < termList.size(); ++ti) {
-            QString t = termList[ti];
-            QString cellText;
-            if (aRowIt != slrTable.action.end()) {
-                auto it = aRowIt.value().find(t);
-                if (it != aRowIt.value().end()) {
-                    const ActionEntry &ae = it.value();
-                    if (ae.type == ActionEntry::Shift) {
-                        cellText = QString::number(ae.target);
-                    } else if (ae.type == ActionEntry::Reduce) {
-                        cellText = tr("r%1").arg(ae.target);
-                    } else if (ae.type == ActionEntry::Accept) {
-                        cellText = "acc";
-                    }
-                }
+void MainWindow::lr1BuildProgress(int states, int queued)
+{
+    if (!lr1Task) return;
+    statusBar()->showMessage(tr("%1 构造中：已发现 %2 个状态，待展开 %3 个")
+                             .arg(lr1Task->options().minimal ? tr("最小 LR(1)") : "LR(1)").arg(states).arg(queued));
+}
+
+void MainWindow::on_actionCancelBuild_triggered()
+{
+    if (lr1Task) lr1Task->cancel();
+}
+
+void MainWindow::lr1BuildFinished()
+{
+    QScopedPointer<LR1BuildTask> task(lr1Task);
+    lr1Task = nullptr;
+    ui->actionCancelBuild->setEnabled(false);
+
+    const bool minimal = task->options().minimal;
+    const QString name = minimal ? tr("最小 LR(1)") : "LR(1)";
+    if (!task->errorMessage().isEmpty()) {
+        if (lr1TaskLive) statusBar()->showMessage(tr("文法错误：%1").arg(task->errorMessage()));
+        else QMessageBox::warning(this, tr("文法错误"), task->errorMessage());
+        return;
+    }
+    if (task->wasCancelled()) {
+        statusBar()->showMessage(tr("%1 构造已取消").arg(name));
+        return;
+    }
+
+    *grammar = task->resultGrammar();
+    previousGrammar = *grammar;
+    reportReduction(task->reduction(), lr1TaskLive);
+    QSharedPointer<LRAnalyzer> shared = task->analyzer();
+    const LRAnalyzer &analyzer = *shared;
+    const QVector<LR1State> &states = analyzer.getLR1States();
+    showLR1Automaton(shared);
+
+    setParseTable(analyzer, analyzer.getLR1ParseTable(), states.size(), name,
+                  GLRTable::LR1, !analyzer.getLR1Conflicts().isEmpty());
+    parseTableSource = task->options().grammarText; // 构造期间文法可能已被修改
+
+    const QString cacheText = task->fromCache() ? tr("（来自缓存）") : QString();
+    if (minimal) {
+        // 与 LALR(1) 相比多出的状态都是为避免合并冲突而拆分出来的
+        int coreCount = analyzer.lr1CoreCount();
+        statusBar()->showMessage(tr("最小 LR(1)：%1 个状态（LALR(1) 为 %2 个，拆分 %3 个），%4 处冲突%5，用时 %6 ms")
+                                 .arg(states.size()).arg(coreCount).arg(states.size() - coreCount)
+                                 .arg(analyzer.getLR1Conflicts().size()).arg(cacheText).arg(task->elapsedMs()));
+    } else {
+        statusBar()->showMessage(tr("LR(1)：%1 个状态，%2 处冲突%3，用时 %4 ms").arg(states.size())
+                                 .arg(analyzer.getLR1Conflicts().size()).arg(cacheText).arg(task->elapsedMs()));
+        previousLR1 = shared;
+    }
+    if (lr1TaskLive) {
+        // 从发起到界面更新完毕的总用时，与同步构造的自动刷新口径一致
+        statusBar()->showMessage(tr("%1（自动刷新用时 %2 ms）").arg(statusBar()->currentMessage()).arg(lr1Timer.elapsed()));
+    }
+}
+
+void MainWindow::on_actionBuildLALRTable_triggered()
+{
+    if (!prepareGrammar()) return;
+    lastBuildAction = ui->actionBuildLALRTable;
+
+    QSharedPointer<LRAnalyzer> shared(new LRAnalyzer(*grammar));
+    LRAnalyzer &analyzer = *shared;
+    analyzer.buildLR0();
+    analyzer.buildLALRTable();
+
+    const QVector<LR0State> &states = analyzer.getLR0States();
+    const Grammar &augG = analyzer.getAugmentedGrammar();
+
+    // LALR(1) 状态即 LR(0) 状态，完成项目后附上计算出的向前看集合
+    setTableModel(ui->tableLR1States, new LRStateModel(states.size(), [shared](int stateId) {
+        const Grammar &g = shared->getAugmentedGrammar();
+        QStringList itemStrs;
+        for (const LR0Item &it : shared->lr0Closure(stateId)) {
+            QString itemText = lr0ItemToString(g, it);
+            if (it.dotPos == g.productions[it.prodId].right.size()) {
+                QStringList la;
+                shared->lalrLookahead(stateId, it.prodId).forEach([&](int t) { la << g.symbolName(t); });
+                itemText = QString("[%1, %2]").arg(itemText, la.join("/"));
             }
-            ui->tableSLR->setItem(i, 3 + ti, new QTableWidgetItem(cellText));
+            itemStrs << itemText;
         }
+        return itemStrs.join("\n");
+    }, ui->tableLR1States));
+    setTableModel(ui->tableLR1Trans, TransitionModel::fromStates(augG, states, ui->tableLR1Trans));
+    setTableModel(ui->tableLR1Parse, new ActionGotoModel(augG, analyzer.getLALRTable(), states.size(),
+                                                         ActionGotoModel::Plain, ui->tableLR1Parse));
 
-        // 填 Goto 列
-        auto gRowIt = slrTable.goTo.find(stateId);
-        for (int ni = 0; ni < nonTermList.size(); ++ni) {
-            QString nt = nonTermList[ni];
-            QString cellText;
-            if (gRowIt != slrTable.goTo.end()) {
-                auto it = gRowIt.value().find(nt);
-                if (it != gRowIt.value().end()) {
-                    cellText = QString::number(it.value());
-                }
-            }
-            ui->tableSLR->setItem(i, 3 + termList.size() + ni, new QTableWidgetItem(cellText));
+    const QList<ConflictInfo> &conflicts = analyzer.getLALRConflicts();
+    setParseTable(analyzer, analyzer.getLALRTable(), states.size(), "LALR(1)", GLRTable::LALR1, !conflicts.isEmpty());
+
+    statusBar()->showMessage(tr("LALR(1)：%1 个状态，%2 处冲突").arg(states.size()).arg(conflicts.size()));
+    if (!conflicts.isEmpty() && !liveRefresh) {
+        QStringList lines;
+        for (const ConflictInfo &c : conflicts) {
+            lines << c.description;
         }
+        QMessageBox::information(this, tr("该文法不是 LALR(1) 文法"), lines.join("\n"));
     }
 }
 
-void MainWindow::on_actionBuildLR1Table_triggered()
+// 解析编辑框中的文法，删去无用符号后求 FIRST/FOLLOW；增量模式下只重算受修改影响的非终结符
+bool MainWindow::prepareGrammar()
 {
-    QString text = ui->grammarEdit->toPlainText();
     QString error;
-    if (!grammar->parseFromText(text, error)) {
-        QMessageBox::warning(this, tr("文法错误"), error);
-        return;
+    if (!grammar->parseFromText(ui->grammarEdit->toPlainText(), error)) {
+        if (liveRefresh) statusBar()->showMessage(tr("文法错误：%1").arg(error));
+        else QMessageBox::warning(this, tr("文法错误"), error);
+        return false;
+    }
+    reportReduction(grammar->removeUselessSymbols(), liveRefresh);
+    if (ui->actionIncrementalMode->isChecked()) {
+        grammar->updateFirstFollow(previousGrammar);
+    } else {
+        grammar->computeFirst();
+        grammar->computeFollow();
     }
-    grammar->computeFirst();
-    grammar->computeFollow();
+    previousGrammar = *grammar;
+    return true;
+}
 
-    LRAnalyzer analyzer(*grammar);
-    analyzer.buildLR1();
-    analyzer.buildLR1Table();
+// 删去了无用符号时提示一次删去的内容；自动刷新时不弹对话框，留到下一次手动构造再提示
+void MainWindow::reportReduction(const GrammarReduction &reduction, bool live)
+{
+    const QString text = reduction.toString();
+    if (live || text == reportedReduction) return;
+    reportedReduction = text;
+    if (!text.isEmpty()) QMessageBox::information(this, tr("已删去无用符号"), text);
+}
 
-    const QVector<LR1State> &states = analyzer.getLR1States();
-    const Grammar &augG = analyzer.getAugmentedGrammar();
+void MainWindow::on_actionIncrementalMode_toggled(bool checked)
+{
+    if (checked) refreshTimer->start();
+    else refreshTimer->stop();
+}
 
-    // LR(1) 状态项目集
-    ui->tableLR1States->clear();
-    ui->tableLR1States->setColumnCount(2);
-    ui->tableLR1States->setHorizontalHeaderLabels(QStringList() << tr("状态") << tr("项目集"));
-    ui->tableLR1States->setRowCount(states.size());
+// 编辑停顿后重新执行最近一次构造
+void MainWindow::refreshAnalysis()
+{
+    if (!lastBuildAction) return;
+    QElapsedTimer timer;
+    timer.start();
+    LR1BuildTask *running = lr1Task;
+    liveRefresh = true;
+    lastBuildAction->trigger();
+    liveRefresh = false;
+    // 这次触发的是后台 LR(1) 构造：此刻只是启动了线程，用时在 lr1BuildFinished 中报告
+    if (lr1Task && lr1Task != running) return;
+    statusBar()->showMessage(tr("%1（自动刷新用时 %2 ms）").arg(statusBar()->currentMessage()).arg(timer.elapsed()));
+}
 
-    for (int i = 0; i < states.size(); ++i) {
-        const LR1State &s = states[i];
-        ui->tableLR1States->setItem(i, 0, new QTableWidgetItem(QString::number(s.id)));
-        QStringList itemStrs;
-        for (const LR1Item &it : s.items) {
-            itemStrs << lr1ItemToString(augG, it);
-        }
-        ui->tableLR1States->setItem(i, 1, new QTableWidgetItem(itemStrs.join("\n")));
+// 有冲突时 LRTable 每格只保留了先写入的动作，另外构造保留全部动作的 GLR 表供句子分析使用
+void MainWindow::setParseTable(const LRAnalyzer &analyzer, const LRTable &table, int stateCount, const QString &name,
+                               GLRTable::Lookahead kind, bool conflicted)
+{
+    parseGrammar = analyzer.getAugmentedGrammar();
+    parseTable.build(table, parseGrammar, stateCount);
+    parseTableName = name;
+    parseTableSource = ui->grammarEdit->toPlainText();
+    useGLR = conflicted;
+    if (useGLR) glrTable.build(analyzer, kind);
+}
+
+bool MainWindow::checkParseTable()
+{
+    if (parseTableName.isEmpty()) {
+        QMessageBox::information(this, tr("提示"), tr("请先构造 SLR(1)、LR(1) 或 LALR(1) 分析表。"));
+        return false;
     }
-    ui->tableLR1States->resizeRowsToContents();
+    if (parseTableSource != ui->grammarEdit->toPlainText()) {
+        QMessageBox::information(this, tr("提示"), tr("文法已修改，请重新构造分析表。"));
+        return false;
+    }
+    return true;
+}
 
-    // LR(1) 转移表（点与边数据）
-    ui->tableLR1Trans->clear();
-    ui->tableLR1Trans->setColumnCount(3);
-    ui->tableLR1Trans->setHorizontalHeaderLabels(QStringList() << tr("From") << tr("Symbol") << tr("To"));
+void MainWindow::on_actionAnalyzeSentence_triggered()
+{
+    if (!checkParseTable()) return;
 
-    int edgeRowCount = 0;
-    for (const LR1State &s : states) {
-        edgeRowCount += s.transitions.size();
+    QVector<int> tokens;
+    QString error;
+    if (!LRParser::tokenize(parseGrammar, ui->lineSentence->text(), tokens, error)) {
+        QMessageBox::warning(this, tr("句子错误"), error);
+        return;
     }
-    ui->tableLR1Trans->setRowCount(edgeRowCount);
-
-    int r = 0;
-    for (const LR1State &s : states) {
-        for (auto it = s.transitions.begin(); it != s.transitions.end(); ++it) {
-            ui->tableLR1Trans->setItem(r, 0, new QTableWidgetItem(QString::number(s.id)));
-            ui->tableLR1Trans->setItem(r, 1, new QTableWidgetItem(it.key()));
-            ui->tableLR1Trans->setItem(r, 2, new QTableWidgetItem(QString::number(it.value())));
-            ++r;
-        }
+    if (useGLR) {
+        analyzeSentenceGLR(tokens);
+        return;
     }
 
-    // LR(1) 分析表
-    const LRTable &table = analyzer.getLR1ParseTable();
-
-    // 终结符列（含 #）
-    QSet<QString> terminals = grammar->terminals;
-    terminals.insert(grammar->endMarker);
-    QStringList termList = terminals.values();
-    termList.sort();
-
-    // 非终结符列
-    QStringList nonTermList = grammar->nonTerminals.values();
-    nonTermList.sort();
-
-    int colCount = 1 + termList.size() + nonTermList.size();
-    ui->tableLR1Parse->clear();
-    ui->tableLR1Parse->setColumnCount(colCount);
-
-    QStringList headers;
-    headers << tr("状态");
-    for (const QString &t : termList) headers << t;
-    for (const QString &nt : nonTermList) headers << nt;
-    ui->tableLR1Parse->setHorizontalHeaderLabels(headers);
-
-    ui->tableLR1Parse->setRowCount(states.size());
-    for (int i = 0; i < states.size(); ++i) {
-        int stateId = states[i].id;
-        ui->tableLR1Parse->setItem(i, 0, new QTableWidgetItem(QString::number(stateId)));
-
-        // ACTION
-        for (int ti = 0; ti < termList.size(); ++ti) {
-            QString t = termList[ti];
-            QString textCell;
-            auto sit = table.action.find(stateId);
-            if (sit != table.action.end()) {
-                auto ait = sit.value().find(t);
-                if (ait != sit.value().end()) {
-                    const ActionEntry &ae = ait.value();
-                    if (ae.type == ActionEntry::Shift) textCell = QString("s%1").arg(ae.target);
-                    else if (ae.type == ActionEntry::Reduce) textCell = QString("r%1").arg(ae.target);
-                    else if (ae.type == ActionEntry::Accept) textCell = "acc";
-                }
+    LRParser parser(parseTable);
+    parser.setTrace(ui->checkTrace->isChecked());
+    bool accepted = parser.parse(tokens);
+
+    if (ui->checkTrace->isChecked()) {
+        // 分析过程：步骤 | 状态栈 | 符号栈 | 剩余输入 | 动作
+        const QVector<ParseStep> &steps = parser.steps();
+        ui->tableSteps->clear();
+        ui->tableSteps->setColumnCount(5);
+        ui->tableSteps->setHorizontalHeaderLabels(QStringList() << tr("步骤") << tr("状态栈") << tr("符号栈")
+                                                                << tr("剩余输入") << tr("动作"));
+        ui->tableSteps->setRowCount(steps.size());
+        for (int i = 0; i < steps.size(); ++i) {
+            const ParseStep &step = steps[i];
+            QStringList stateTexts, symbolTexts, inputTexts;
+            for (int st : step.states) stateTexts << QString::number(st);
+            symbolTexts << parseGrammar.endMarker;
+            for (int sym : step.symbols) symbolTexts << parseGrammar.symbolName(sym);
+            for (int k = step.inputPos; k < tokens.size(); ++k) inputTexts << parseGrammar.symbolName(tokens[k]);
+
+            QString actionText;
+            if (CompiledTable::isShift(step.action)) {
+                actionText = QString("s%1").arg(CompiledTable::shiftTarget(step.action));
+            } else if (CompiledTable::isReduce(step.action)) {
+                int prodId = CompiledTable::reduceProduction(step.action);
+                actionText = QString("r%1: %2").arg(prodId).arg(parseGrammar.productionToString(prodId));
+            } else if (step.action == CompiledTable::Accept) {
+                actionText = "acc";
+            } else {
+                actionText = tr("出错");
             }
-            ui->tableLR1Parse->setItem(i, 1 + ti, new QTableWidgetItem(textCell));
+
+            ui->tableSteps->setItem(i, 0, new QTableWidgetItem(QString::number(i + 1)));
+            ui->tableSteps->setItem(i, 1, new QTableWidgetItem(stateTexts.join(" ")));
+            ui->tableSteps->setItem(i, 2, new QTableWidgetItem(symbolTexts.join(" ")));
+            ui->tableSteps->setItem(i, 3, new QTableWidgetItem(inputTexts.join(" ")));
+            ui->tableSteps->setItem(i, 4, new QTableWidgetItem(actionText));
         }
+    }
 
-        // GOTO
-        for (int ni = 0; ni < nonTermList.size(); ++ni) {
-            QString nt = nonTermList[ni];
-            QString textCell;
-            auto sit = table.goTo.find(stateId);
-            if (sit != table.goTo.end()) {
-                auto git = sit.value().find(nt);
-                if (git != sit.value().end()) {
-                    textCell = QString::number(git.value());
-                }
+    if (accepted) {
+        statusBar()->showMessage(tr("%1 分析：句子被接受").arg(parseTableName));
+    } else {
+        int pos = parser.errorPosition();
+        statusBar()->showMessage(tr("%1 分析：在第 %2 个符号 %3 处出错")
+                                 .arg(parseTableName).arg(pos + 1).arg(parseGrammar.symbolName(tokens[pos])));
+    }
+}
+
+// 冲突的分析表：用 GLR 分析，跟踪时列出分析森林中的节点
+void MainWindow::analyzeSentenceGLR(const QVector<int> &tokens)
+{
+    GLRParser parser(glrTable);
+    bool accepted = parser.parse(tokens);
+
+    if (accepted && ui->checkTrace->isChecked()) {
+        // 分析森林：节点 | 符号 | 覆盖的输入 | 推导
+        const QVector<SPPFNode> &nodes = parser.forestNodes();
+        const QVector<PackedNode> &packed = parser.forestPackedNodes();
+        ui->tableSteps->clear();
+        ui->tableSteps->setColumnCount(4);
+        ui->tableSteps->setHorizontalHeaderLabels(QStringList() << tr("节点") << tr("符号") << tr("覆盖输入") << tr("推导"));
+        ui->tableSteps->setRowCount(nodes.size());
+        for (int i = 0; i < nodes.size(); ++i) {
+            const SPPFNode &n = nodes[i];
+            QStringList inputTexts, derivations;
+            for (int k = n.start; k < n.end; ++k) inputTexts << parseGrammar.symbolName(tokens[k]);
+            for (int p : n.packed) {
+                QStringList children;
+                for (int c : packed[p].children) children << QString::number(c);
+                derivations << QString("r%1 [%2]").arg(packed[p].prodId).arg(children.join(" "));
             }
-            ui->tableLR1Parse->setItem(i, 1 + termList.size() + ni, new QTableWidgetItem(textCell));
+            ui->tableSteps->setItem(i, 0, new QTableWidgetItem(QString::number(i)));
+            ui->tableSteps->setItem(i, 1, new QTableWidgetItem(parseGrammar.symbolName(n.symbol)));
+            ui->tableSteps->setItem(i, 2, new QTableWidgetItem(inputTexts.join(" ")));
+            ui->tableSteps->setItem(i, 3, new QTableWidgetItem(derivations.join(" | ")));
         }
+    } else if (!accepted) {
+        // 出错时没有分析森林；清掉上一句的结果，免得被当成这一句的
+        ui->tableSteps->clear();
+        ui->tableSteps->setRowCount(0);
+        ui->tableSteps->setColumnCount(0);
+    }
+
+    if (accepted) {
+        qint64 trees = parser.treeCount(parser.root());
+        QString treeText = trees < 0 ? tr("无穷多") : QString::number(trees);
+        statusBar()->showMessage(tr("%1 GLR 分析：句子被接受，%2 棵分析树（GSS %3 个节点），其一：%4")
+                                 .arg(parseTableName, treeText).arg(parser.gssNodeCount())
+                                 .arg(parser.firstTreeToString(parseGrammar, parser.root())));
+    } else {
+        int pos = parser.errorPosition();
+        statusBar()->showMessage(tr("%1 GLR 分析：在第 %2 个符号 %3 处出错")
+                                 .arg(parseTableName).arg(pos + 1).arg(parseGrammar.symbolName(tokens[pos])));
     }
 }
 
-void MainWindow::on_actionAnalyzeSentence_triggered()
+void MainWindow::on_actionBatchAnalyze_triggered()
 {
-    // 留空：可选做，基于 LR(1) 表模拟分析过程并填充 tableSteps
-    QMessageBox::information(this, tr("提示"), tr("句子分析功能为选做，可按需要自行补充。"));
+    if (!checkParseTable()) return;
+
+    QString fileName = QFileDialog::getOpenFileName(this, tr("打开句子文件"), QString(), tr("Text Files (*.txt);;All Files (*.*)"));
+    if (fileName.isEmpty()) return;
+
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("错误"), tr("无法打开文件: %1").arg(fileName));
+        return;
+    }
+    QTextStream in(&f);
+    const QStringList lines = in.readAll().split('\n');
+    f.close();
+
+    // 先全部分词，计时只包含分析本身；每行一个句子，空行跳过
+    QVector<QVector<int>> sentences;
+    QVector<int> lineNumbers;
+    QStringList rejected;
+    int unknownCount = 0;
+    for (int i = 0; i < lines.size(); ++i) {
+        if (lines[i].trimmed().isEmpty()) continue;
+        QVector<int> tokens;
+        QString error;
+        if (!LRParser::tokenize(parseGrammar, lines[i], tokens, error)) {
+            ++unknownCount;
+            rejected << QString::number(i + 1);
+            continue;
+        }
+        sentences.append(tokens);
+        lineNumbers.append(i + 1);
+    }
+
+    LRParser parser(parseTable);
+    GLRParser glrParser(glrTable);
+    int acceptedCount = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < sentences.size(); ++i) {
+        if (useGLR ? glrParser.parse(sentences[i]) : parser.parse(sentences[i])) {
+            ++acceptedCount;
+        } else {
+            rejected << QString::number(lineNumbers[i]);
+        }
+    }
+    double ms = timer.nsecsElapsed() / 1e6;
+
+    int total = sentences.size() + unknownCount;
+    QString report = tr("%1 分析 %2 句：接受 %3 句，拒绝 %4 句（其中 %5 句含未知符号）\n分析耗时 %6 ms，%7 句/秒")
+                         .arg(useGLR ? parseTableName + " GLR" : parseTableName).arg(total).arg(acceptedCount).arg(total - acceptedCount).arg(unknownCount)
+                         .arg(ms, 0, 'f', 2)
+                         .arg(ms > 0 ? sentences.size() * 1000.0 / ms : 0.0, 0, 'f', 0);
+    if (!rejected.isEmpty()) {
+        std::sort(rejected.begin(), rejected.end(), [](const QString &a, const QString &b) { return a.toInt() < b.toInt(); });
+        const int shown = 20;
+        report += tr("\n被拒绝的行：%1").arg(rejected.mid(0, shown).join(", "));
+        if (rejected.size() > shown) report += " ...";
+    }
+    statusBar()->showMessage(report.section('\n', 0, 0));
+    QMessageBox::information(this, tr("批量分析"), report);
 }
@@ -1,13 +1,22 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QElapsedTimer>
 #include <QMainWindow>
+#include <QScopedPointer>
+#include <QSharedPointer>
 
+#include "compiledtable.h"
+#include "glrparser.h"
 #include "grammar.h"
 
 class QPlainTextEdit;
 class QTableWidget;
 class QLineEdit;
+class QTimer;
+class LRAnalyzer;
+class LR1BuildTask;
+struct LRTable;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -28,13 +37,54 @@ private:
 
     // 文法
     Grammar *grammar;
+    QString grammarFileName; // 最近打开/保存的文法文件，LR(1) 表缓存放在它旁边
+
+    // 最近一次构造的分析表，供句子分析使用
+    CompiledTable parseTable;
+    Grammar parseGrammar;     // 对应的增广文法
+    QString parseTableName;   // "SLR(1)"、"LR(1)" 等，为空表示尚未构造
+    QString parseTableSource; // 构造时的文法文本
+    GLRTable glrTable;        // 分析表有冲突时构造，句子改用 GLR 分析
+    bool useGLR = false;
+
+    // 增量模式：编辑停顿后自动重新执行最近一次构造，FIRST/FOLLOW 与 LR(1) 自动机在上一次结果上增量更新
+    Grammar previousGrammar;                      // 上一次成功解析的文法（已求 FIRST/FOLLOW）
+    QSharedPointer<const LRAnalyzer> previousLR1; // 上一次构造的规范 LR(1) 自动机
+    QAction *lastBuildAction = nullptr;
+    QTimer *refreshTimer;
+    bool liveRefresh = false;                     // 编辑触发的刷新：错误显示在状态栏而不弹对话框，也不写缓存
+
+    // 后台进行中的 LR(1) 构造
+    LR1BuildTask *lr1Task = nullptr;
+    bool lr1TaskLive = false;                     // 由编辑触发的刷新发起
+    QElapsedTimer lr1Timer;                       // 从发起构造时开始计时
+
+    QString reportedReduction; // 最近一次提示过的无用符号报告，同样的内容不重复提示
+
+    bool prepareGrammar();
+    void reportReduction(const GrammarReduction &reduction, bool live);
+    void setParseTable(const LRAnalyzer &analyzer, const LRTable &table, int stateCount, const QString &name,
+                       GLRTable::Lookahead kind, bool conflicted);
+    void analyzeSentenceGLR(const QVector<int> &tokens);
+    bool checkParseTable();
+    void startLR1Build(bool minimal);
+    void showLR1Automaton(const QSharedPointer<LRAnalyzer> &shared);
 
 private slots:
     void on_actionOpenGrammar_triggered();
     void on_actionSaveGrammar_triggered();
+    void on_actionExportParser_triggered();
     void on_actionComputeFirstFollow_triggered();
     void on_actionBuildLR0SLR_triggered();
     void on_actionBuildLR1Table_triggered();
+    void on_actionBuildMinimalLR1Table_triggered();
+    void on_actionBuildLALRTable_triggered();
     void on_actionAnalyzeSentence_triggered();
+    void on_actionBatchAnalyze_triggered();
+    void on_actionCancelBuild_triggered();
+    void on_actionIncrementalMode_toggled(bool checked);
+    void refreshAnalysis();
+    void lr1BuildProgress(int states, int queued);
+    void lr1BuildFinished();
 };
 #endif // MAINWINDOW_H
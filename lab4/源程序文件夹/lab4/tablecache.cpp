@@ -0,0 +1,310 @@
+#include "tablecache.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace {
+
+class CacheWriter
+{
+public:
+    QByteArray data;
+
+    void put(qint32 v)
+    {
+        qint32 le = qToLittleEndian(v);
+        data.append(reinterpret_cast<const char *>(&le), sizeof(le));
+    }
+    void putBytes(const QByteArray &bytes)
+    {
+        put(bytes.size());
+        data.append(bytes);
+        while (data.size() % 4) data.append('\0');
+    }
+    void putString(const QString &s) { putBytes(s.toUtf8()); }
+    void putTerminals(const TerminalSet &set)
+    {
+        const QVector<int> list = set.toList();
+        put(list.size());
+        for (int t : list) put(t);
+    }
+};
+
+// 所有读取都检查边界；index() 额外检查取值范围，越界时 ok 置为 false 并返回 0，
+// 这样损坏的缓存文件只会导致加载失败，而不会构造出非法的状态
+class CacheReader
+{
+public:
+    CacheReader(const uchar *begin, qint64 size) : p(begin), end(begin + size) {}
+
+    bool ok = true;
+
+    qint32 get()
+    {
+        if (end - p < 4) {
+            ok = false;
+            return 0;
+        }
+        qint32 v = qFromLittleEndian<qint32>(p);
+        p += 4;
+        return v;
+    }
+    int index(int limit)
+    {
+        qint32 v = get();
+        if (v < 0 || v >= limit) {
+            ok = false;
+            return 0;
+        }
+        return v;
+    }
+    QByteArray getBytes()
+    {
+        qint32 n = get();
+        qint64 padded = (qint64(n) + 3) / 4 * 4;
+        if (!ok || n < 0 || end - p < padded) {
+            ok = false;
+            return QByteArray();
+        }
+        QByteArray bytes(reinterpret_cast<const char *>(p), n);
+        p += padded;
+        return bytes;
+    }
+    QString getString() { return QString::fromUtf8(getBytes()); }
+    TerminalSet getTerminals(int terminalCount)
+    {
+        TerminalSet set(terminalCount);
+        const int n = get();
+        for (int k = 0; k < n && ok; ++k) set.insert(index(terminalCount));
+        return set;
+    }
+
+private:
+    const uchar *p;
+    const uchar *end;
+};
+
+} // namespace
+
+QString TableCache::cacheFileName(const QString &grammarFile, const QString &kind)
+{
+    return QString("%1.%2.cache").arg(grammarFile, kind);
+}
+
+QByteArray TableCache::grammarKey(const Grammar &g, const QString &kind)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(kind.toUtf8());
+    for (const Production &p : g.productions) {
+        hash.addData("\n");
+        hash.addData(g.productionToString(p.id).toUtf8());
+        hash.addData(QByteArray::number(p.precedence));
+    }
+    // 优先级改变时表格随之改变
+    for (const Precedence &prec : g.terminalPrecedence) {
+        hash.addData(QString(" %1/%2").arg(prec.level).arg(int(prec.assoc)).toUtf8());
+    }
+    return hash.result();
+}
+
+bool TableCache::save(const QString &fileName, const QByteArray &key, const LRAnalyzer &analyzer)
+{
+    const Grammar &g = analyzer.augmentedGrammar;
+    CacheWriter w;
+    w.put(Magic);
+    w.put(Version);
+    w.putBytes(key);
+
+    // 增广文法：符号表 + 产生式
+    w.put(g.symbols.size());
+    w.put(g.symbols.terminalCount);
+    for (const QString &name : g.symbols.names) w.putString(name);
+    w.put(g.startSymbol);
+    w.put(analyzer.augmentedStartProdId);
+    w.put(g.productions.size());
+    for (const Production &p : g.productions) {
+        w.put(p.left);
+        w.put(p.right.size());
+        for (int sym : p.right) w.put(sym);
+        w.put(p.precedence);
+    }
+    for (const Precedence &prec : g.terminalPrecedence) {
+        w.put(prec.level);
+        w.put(int(prec.assoc));
+    }
+
+    // LR(1) 状态：内核按核心项目有序写出，每个核心项目后跟向前看终结符列表，
+    // 保证同一文法生成的文件逐字节相同；完成项目同样按产生式有序写出
+    w.put(analyzer.lr1States.size());
+    for (const LR1State &s : analyzer.lr1States) {
+        w.put(s.kernel.size());
+        for (auto it = s.kernel.begin(); it != s.kernel.end(); ++it) {
+            w.put(it.key().prodId);
+            w.put(it.key().dotPos);
+            w.putTerminals(it.value());
+        }
+        w.put(s.transitions.size());
+        for (auto it = s.transitions.begin(); it != s.transitions.end(); ++it) {
+            w.put(it.key());
+            w.put(it.value());
+        }
+        w.put(s.reductions.size());
+        for (auto it = s.reductions.begin(); it != s.reductions.end(); ++it) {
+            w.put(it.key());
+            w.putTerminals(it.value());
+        }
+    }
+
+    // 分析表：每个状态一行
+    const LRTable &table = analyzer.lr1Table;
+    for (int s = 0; s < analyzer.lr1States.size(); ++s) {
+        const QMap<int, ActionEntry> actions = table.action.value(s);
+        w.put(actions.size());
+        for (auto it = actions.begin(); it != actions.end(); ++it) {
+            w.put(it.key());
+            w.put(it.value().type);
+            w.put(it.value().target);
+        }
+        const QMap<int, int> gotos = table.goTo.value(s);
+        w.put(gotos.size());
+        for (auto it = gotos.begin(); it != gotos.end(); ++it) {
+            w.put(it.key());
+            w.put(it.value());
+        }
+    }
+
+    w.put(analyzer.lr1Conflicts.size());
+    for (const ConflictInfo &c : analyzer.lr1Conflicts) w.putString(c.description);
+
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    if (f.write(w.data) != w.data.size()) {
+        f.cancelWriting();
+        return false;
+    }
+    return f.commit();
+}
+
+// 读取文件头之后的全部内容；任何一处不合法都返回 false
+static bool readPayload(CacheReader &r, Grammar &g, int &augmentedStartProdId, QVector<LR1State> &states,
+                        LRTable &table, QList<ConflictInfo> &conflicts)
+{
+    const int symbolCount = r.get();
+    const int terminalCount = r.get();
+    if (!r.ok || symbolCount <= 0 || terminalCount <= 0 || terminalCount > symbolCount) return false;
+    for (int i = 0; i < symbolCount && r.ok; ++i) {
+        QString name = r.getString();
+        if (i < terminalCount) g.symbols.addTerminal(name);
+        else g.symbols.addNonTerminal(name);
+    }
+    if (!r.ok || g.symbols.size() != symbolCount || g.symbols.terminalCount != terminalCount) return false;
+
+    g.prodsByLeft.resize(symbolCount);
+    g.startSymbol = r.index(symbolCount);
+    augmentedStartProdId = r.get();
+    const int prodCount = r.get();
+    for (int i = 0; i < prodCount && r.ok; ++i) {
+        Production p;
+        p.id = i;
+        p.left = r.index(symbolCount);
+        const int len = r.get();
+        for (int k = 0; k < len && r.ok; ++k) p.right.append(r.index(symbolCount));
+        p.precedence = r.get();
+        if (!g.isNonTerminal(p.left)) return false;
+        g.productions.append(p);
+        g.prodsByLeft[p.left].append(p.id);
+    }
+    if (!r.ok || augmentedStartProdId < 0 || augmentedStartProdId >= prodCount) return false;
+    g.terminalPrecedence.resize(terminalCount);
+    for (Precedence &prec : g.terminalPrecedence) {
+        prec.level = r.get();
+        prec.assoc = Precedence::Assoc(r.index(Precedence::NonAssoc + 1));
+    }
+
+    const int stateCount = r.get();
+    if (!r.ok || stateCount <= 0) return false;
+    for (int s = 0; s < stateCount && r.ok; ++s) {
+        LR1State state;
+        state.id = s;
+        const int itemCount = r.get();
+        for (int k = 0; k < itemCount && r.ok; ++k) {
+            LR0Item core;
+            core.prodId = r.index(prodCount);
+            core.dotPos = r.index(g.productions[core.prodId].right.size() + 1);
+            state.kernel.insert(core, r.getTerminals(terminalCount));
+        }
+        const int transCount = r.get();
+        for (int k = 0; k < transCount && r.ok; ++k) {
+            int X = r.index(symbolCount);
+            state.transitions.insert(X, r.index(stateCount));
+        }
+        const int reductionCount = r.get();
+        for (int k = 0; k < reductionCount && r.ok; ++k) {
+            int prodId = r.index(prodCount);
+            state.reductions.insert(prodId, r.getTerminals(terminalCount));
+        }
+        states.append(state);
+    }
+
+    for (int s = 0; s < stateCount && r.ok; ++s) {
+        const int actionCount = r.get();
+        for (int k = 0; k < actionCount && r.ok; ++k) {
+            int term = r.index(terminalCount);
+            ActionEntry ae;
+            ae.type = ActionEntry::Type(r.index(ActionEntry::Error + 1));
+            if (ae.type == ActionEntry::Shift) ae.target = r.index(stateCount);
+            else if (ae.type == ActionEntry::Reduce) ae.target = r.index(prodCount);
+            else ae.target = r.get();
+            table.action[s][term] = ae;
+        }
+        const int gotoCount = r.get();
+        for (int k = 0; k < gotoCount && r.ok; ++k) {
+            int nt = r.index(symbolCount);
+            table.goTo[s][nt] = r.index(stateCount);
+        }
+    }
+
+    const int conflictCount = r.get();
+    for (int k = 0; k < conflictCount && r.ok; ++k) {
+        conflicts.append(ConflictInfo{r.getString()});
+    }
+    return r.ok;
+}
+
+bool TableCache::load(const QString &fileName, const QByteArray &key, LRAnalyzer &analyzer)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    const qint64 size = f.size();
+    uchar *mapped = f.map(0, size);
+    if (!mapped) return false;
+
+    Grammar g;
+    int augmentedStartProdId = -1;
+    QVector<LR1State> states;
+    LRTable table;
+    QList<ConflictInfo> conflicts;
+
+    CacheReader r(mapped, size);
+    bool ok = r.get() == qint32(Magic) && r.get() == qint32(Version) && r.getBytes() == key && r.ok
+              && readPayload(r, g, augmentedStartProdId, states, table, conflicts);
+    f.unmap(mapped);
+    f.close();
+    if (!ok) return false;
+
+    // 闭包计算需要增广文法的 FIRST，重新求一遍比存入文件更简单，代价也只是线性的
+    g.computeFirst();
+    g.computeFollow();
+
+    analyzer.augmentedGrammar = g;
+    analyzer.augmentedStartProdId = augmentedStartProdId;
+    analyzer.lr1States = states;
+    analyzer.lazy.reset();
+    analyzer.lr1KernelIndex.clear();
+    for (const LR1State &s : analyzer.lr1States) analyzer.lr1KernelIndex.insert(s.kernel, s.id);
+    analyzer.lr1Table = table;
+    analyzer.lr1Conflicts = conflicts;
+    return true;
+}
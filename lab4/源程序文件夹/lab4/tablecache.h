@@ -0,0 +1,32 @@
+#ifndef TABLECACHE_H
+#define TABLECACHE_H
+
+#include "grammar.h"
+#include "lr.h"
+#include <QByteArray>
+#include <QString>
+
+// LR(1) 分析表的磁盘缓存。
+//
+// 缓存文件放在文法文件旁边（<文法文件>.<kind>.cache），内容为增广文法、LR(1) 自动机、
+// LRTable 和冲突信息。文件是小端 32 位整数序列，字符串为 UTF-8 长度 + 字节（按 4 字节对齐），
+// 加载时用 QFile::map() 映射后直接按位置读取，不经过额外的缓冲拷贝。
+// 文件头记录格式版本与文法键；版本或键不符、文件损坏时加载失败，调用方重新构造即可。
+class TableCache
+{
+public:
+    // kind 区分构造方式（如 "lr1"、"minlr1"），出现在文件名和键里
+    static QString cacheFileName(const QString &grammarFile, const QString &kind);
+
+    // 文法键：对产生式的规范文本（与原文中的空白、换行写法无关）及优先级取 SHA-1
+    static QByteArray grammarKey(const Grammar &g, const QString &kind);
+
+    // 读取 LR(1) 状态与分析表到 analyzer；成功后与调用 buildLR1()/buildLR1Table() 的结果相同
+    static bool load(const QString &fileName, const QByteArray &key, LRAnalyzer &analyzer);
+    static bool save(const QString &fileName, const QByteArray &key, const LRAnalyzer &analyzer);
+
+    static constexpr quint32 Magic = 0x4354524c; // "LRTC"
+    static constexpr quint32 Version = 4; // 2：内核按核心项目 + 向前看集合存放；3：加入完成项目；4：加入优先级
+};
+
+#endif // TABLECACHE_H
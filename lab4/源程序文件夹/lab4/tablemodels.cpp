@@ -0,0 +1,181 @@
+#include "tablemodels.h"
+
+LRStateModel::LRStateModel(int stateCount, std::function<QString(int)> itemsText, QObject *parent)
+    : QAbstractTableModel(parent)
+    , stateCount(stateCount)
+    , itemsText(std::move(itemsText))
+    , cache(256)
+{
+}
+
+int LRStateModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : stateCount;
+}
+
+int LRStateModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+const QString &LRStateModel::text(int stateId) const
+{
+    QString *cached = cache.object(stateId);
+    if (!cached) {
+        cached = new QString(itemsText(stateId));
+        cache.insert(stateId, cached);
+    }
+    return *cached;
+}
+
+QVariant LRStateModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    if (index.column() == 0) {
+        return role == Qt::DisplayRole ? QVariant(index.row()) : QVariant();
+    }
+    if (role == Qt::DisplayRole) return QString(text(index.row())).replace('\n', "; ");
+    if (role == Qt::ToolTipRole) return text(index.row());
+    return QVariant();
+}
+
+QVariant LRStateModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Vertical) return section;
+    return section == 0 ? tr("状态") : tr("项目集");
+}
+
+TransitionModel::TransitionModel(const Grammar &g, QVector<Transition> transitions, QObject *parent)
+    : QAbstractTableModel(parent)
+    , grammar(g)
+    , transitions(std::move(transitions))
+{
+}
+
+int TransitionModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : transitions.size();
+}
+
+int TransitionModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 3;
+}
+
+QVariant TransitionModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+
+    const Transition &t = transitions[index.row()];
+    switch (index.column()) {
+    case 0: return t.from;
+    case 1: return grammar.symbolName(t.symbol);
+    default: return t.to;
+    }
+}
+
+QVariant TransitionModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Vertical) return section + 1;
+    switch (section) {
+    case 0: return tr("From");
+    case 1: return tr("Symbol");
+    default: return tr("To");
+    }
+}
+
+ActionGotoModel::ActionGotoModel(const Grammar &g, const LRTable &table, int stateCount, Style style, QObject *parent)
+    : QAbstractTableModel(parent)
+    , grammar(g)
+    , table(table)
+    , stateCount(stateCount)
+    , style(style)
+    , summaryColumns(style == SLR ? 2 : 0)
+{
+    for (int nt = g.symbols.terminalCount; nt < g.symbols.size(); ++nt) {
+        if (nt != g.startSymbol) nonTerminals << nt;
+    }
+}
+
+int ActionGotoModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : stateCount;
+}
+
+int ActionGotoModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 1 + summaryColumns + grammar.symbols.terminalCount + nonTerminals.size();
+}
+
+QString ActionGotoModel::actionText(int stateId, int terminal) const
+{
+    auto sit = table.action.find(stateId);
+    if (sit == table.action.end()) return QString();
+    auto it = sit.value().find(terminal);
+    if (it == sit.value().end()) return QString();
+
+    const ActionEntry &ae = it.value();
+    if (ae.type == ActionEntry::Shift) return style == SLR ? QString::number(ae.target) : QString("s%1").arg(ae.target);
+    if (ae.type == ActionEntry::Reduce) return QString("r%1").arg(ae.target);
+    if (ae.type == ActionEntry::Accept) return "acc";
+    if (ae.type == ActionEntry::Error) return "err";
+    return QString();
+}
+
+// 该状态的动作类型（rules 为 false）或归约规则（rules 为 true）
+QString ActionGotoModel::summaryText(int stateId, bool rules) const
+{
+    QString actionType;
+    QString ruleText;
+    const QMap<int, ActionEntry> row = table.action.value(stateId);
+    for (auto it = row.begin(); it != row.end(); ++it) {
+        const ActionEntry &ae = it.value();
+        if (ae.type == ActionEntry::Shift) {
+            if (!actionType.contains(tr("移进"))) actionType += tr("移进 ");
+        } else if (ae.type == ActionEntry::Reduce) {
+            if (!actionType.contains(tr("归约"))) actionType += tr("归约 ");
+            QString oneRule = grammar.productionToString(ae.target).replace("->", "→");
+            if (!ruleText.contains(oneRule)) {
+                if (!ruleText.isEmpty()) ruleText += " ; ";
+                ruleText += oneRule;
+            }
+        } else if (ae.type == ActionEntry::Accept) {
+            if (!actionType.contains(tr("接收"))) actionType += tr("接收 ");
+        }
+    }
+    return rules ? ruleText : actionType.trimmed();
+}
+
+QVariant ActionGotoModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+
+    const int stateId = index.row();
+    int col = index.column();
+    if (col == 0) return stateId;
+    col -= 1;
+    if (col < summaryColumns) return summaryText(stateId, col == 1);
+    col -= summaryColumns;
+    if (col < grammar.symbols.terminalCount) return actionText(stateId, col);
+    col -= grammar.symbols.terminalCount;
+
+    auto git = table.goTo.find(stateId);
+    if (git == table.goTo.end()) return QVariant();
+    auto it = git.value().find(nonTerminals[col]);
+    return it == git.value().end() ? QVariant() : QVariant(it.value());
+}
+
+QVariant ActionGotoModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Vertical) return section;
+
+    if (section == 0) return tr("状态");
+    section -= 1;
+    if (section < summaryColumns) return section == 0 ? tr("动作") : tr("规则");
+    section -= summaryColumns;
+    if (section < grammar.symbols.terminalCount) return grammar.symbolName(section);
+    return grammar.symbolName(nonTerminals[section - grammar.symbols.terminalCount]);
+}
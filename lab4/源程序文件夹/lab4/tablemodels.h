@@ -0,0 +1,103 @@
+#ifndef TABLEMODELS_H
+#define TABLEMODELS_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include <utility>
+
+#include "grammar.h"
+#include "lr.h"
+
+// 界面上的状态表、转移表与分析表。单元格文本在视图请求时才生成，只格式化可见的格子。
+// 状态表与分析表只保存对分析结果的引用（Qt 容器隐式共享，复制不拷贝数据），打开的代价与状态数、符号数无关；
+// 转移表例外，打开时要把全部转移展平一遍（见 TransitionModel）。
+
+// 状态 | 项目集。项目集文本由 itemsText 按需生成（需要求闭包），最近用过的缓存起来供滚动时复用；
+// 单元格中各项目以分号连接显示在一行，完整的多行文本放在提示中
+class LRStateModel : public QAbstractTableModel
+{
+public:
+    LRStateModel(int stateCount, std::function<QString(int)> itemsText, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    int stateCount;
+    std::function<QString(int)> itemsText;
+    mutable QCache<int, QString> cache;
+
+    const QString &text(int stateId) const;
+};
+
+// From | Symbol | To：每条转移一行。打开时把全部转移复制成一个 (from, symbol, to) 数组，
+// 代价与转移总数成正比（与构造自动机本身同阶），之后每个单元格按行号直接取
+class TransitionModel : public QAbstractTableModel
+{
+public:
+    struct Transition {
+        int from;
+        int symbol;
+        int to;
+    };
+
+    TransitionModel(const Grammar &g, QVector<Transition> transitions, QObject *parent = nullptr);
+
+    template <typename State>
+    static TransitionModel *fromStates(const Grammar &g, const QVector<State> &states, QObject *parent = nullptr)
+    {
+        qsizetype count = 0;
+        for (const State &s : states) count += s.transitions.size();
+        QVector<Transition> transitions;
+        transitions.reserve(count);
+        for (const State &s : states) {
+            for (auto it = s.transitions.begin(); it != s.transitions.end(); ++it) {
+                transitions.append(Transition{s.id, it.key(), it.value()});
+            }
+        }
+        return new TransitionModel(g, std::move(transitions), parent);
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    Grammar grammar;
+    QVector<Transition> transitions;
+};
+
+// ACTION/GOTO 分析表：状态 | [动作 | 规则] | 终结符（含 #）| 非终结符（不含增广开始符）。
+// SLR 样式多出“动作”“规则”两列汇总该状态的动作类型与归约规则，移进格只写目标状态号；
+// 否则移进格写作 sN
+class ActionGotoModel : public QAbstractTableModel
+{
+public:
+    enum Style { Plain, SLR };
+
+    ActionGotoModel(const Grammar &g, const LRTable &table, int stateCount, Style style, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    Grammar grammar;
+    LRTable table;
+    int stateCount;
+    Style style;
+    int summaryColumns;      // SLR 样式为 2
+    QVector<int> nonTerminals; // GOTO 列对应的非终结符
+
+    QString actionText(int stateId, int terminal) const;
+    QString summaryText(int stateId, bool rules) const;
+};
+
+#endif // TABLEMODELS_H
@@ -0,0 +1,140 @@
+#ifndef TERMINALSET_H
+#define TERMINALSET_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+// 终结符集合：按终结符编号（0 .. terminalCount-1）存放的定长位图。
+// FIRST/FOLLOW 以及 LR(1) 的向前看集合都使用它，求并只是逐字或运算。
+class TerminalSet
+{
+public:
+    TerminalSet() = default;
+    explicit TerminalSet(int bitCount) : words((bitCount + 63) / 64, 0) {}
+
+    int capacity() const { return words.size() * 64; }
+
+    // 按 64 位字直接读写，供 LR(1) 构造工作区在扁平数组与集合之间转换
+    int wordCount() const { return words.size(); }
+    const quint64 *constData() const { return words.constData(); }
+    static TerminalSet fromWords(const quint64 *data, int count)
+    {
+        TerminalSet set;
+        set.words = QVector<quint64>(data, data + count);
+        return set;
+    }
+
+    bool contains(int t) const
+    {
+        int w = t >> 6;
+        return w < words.size() && (words[w] >> (t & 63)) & 1;
+    }
+
+    // 返回是否新加入
+    bool insert(int t)
+    {
+        int w = t >> 6;
+        if (w >= words.size()) words.resize(w + 1);
+        quint64 bit = quint64(1) << (t & 63);
+        if (words[w] & bit) return false;
+        words[w] |= bit;
+        return true;
+    }
+
+    // this |= other，返回集合是否发生变化
+    bool unite(const TerminalSet &other)
+    {
+        if (other.words.size() > words.size()) words.resize(other.words.size());
+        bool changed = false;
+        for (int i = 0; i < other.words.size(); ++i) {
+            quint64 merged = words[i] | other.words[i];
+            if (merged != words[i]) {
+                words[i] = merged;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool intersects(const TerminalSet &other) const
+    {
+        int n = qMin(words.size(), other.words.size());
+        for (int i = 0; i < n; ++i) {
+            if (words[i] & other.words[i]) return true;
+        }
+        return false;
+    }
+
+    // other 是否是本集合的子集
+    bool containsAll(const TerminalSet &other) const
+    {
+        for (int i = 0; i < other.words.size(); ++i) {
+            quint64 mine = i < words.size() ? words[i] : 0;
+            if (other.words[i] & ~mine) return false;
+        }
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        for (quint64 w : words) {
+            if (w) return false;
+        }
+        return true;
+    }
+
+    int count() const
+    {
+        int n = 0;
+        for (quint64 w : words) n += qPopulationCount(w);
+        return n;
+    }
+
+    void clear() { words.fill(0); }
+
+    // 按编号从小到大遍历集合中的终结符
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (int i = 0; i < words.size(); ++i) {
+            quint64 w = words[i];
+            while (w) {
+                fn(i * 64 + int(qCountTrailingZeroBits(w)));
+                w &= w - 1;
+            }
+        }
+    }
+
+    QVector<int> toList() const
+    {
+        QVector<int> list;
+        forEach([&](int t) { list.append(t); });
+        return list;
+    }
+
+    bool operator==(const TerminalSet &other) const
+    {
+        int n = qMax(words.size(), other.words.size());
+        for (int i = 0; i < n; ++i) {
+            quint64 a = i < words.size() ? words[i] : 0;
+            quint64 b = i < other.words.size() ? other.words[i] : 0;
+            if (a != b) return false;
+        }
+        return true;
+    }
+    bool operator!=(const TerminalSet &other) const { return !(*this == other); }
+
+    friend size_t qHash(const TerminalSet &key, size_t seed = 0) noexcept
+    {
+        // 忽略末尾的全零字，保证与 operator== 一致
+        int n = key.words.size();
+        while (n > 0 && key.words[n - 1] == 0) --n;
+        return qHashRange(key.words.begin(), key.words.begin() + n, seed);
+    }
+
+private:
+    QVector<quint64> words;
+};
+
+#endif // TERMINALSET_H